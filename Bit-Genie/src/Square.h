@@ -52,7 +52,7 @@ inline Square to_sq<std::string_view>(std::string_view const &sq)
     return static_cast<Square>((sq[0] - 97) + ((sq[1] - 49) * 8));
 }
 
-inline Direction operator+(Direction l, Direction r)
+constexpr Direction operator+(Direction l, Direction r)
 {
     return static_cast<Direction>(to_int(l) + to_int(r));
 }
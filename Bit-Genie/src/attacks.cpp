@@ -0,0 +1,196 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "attacks.h"
+
+namespace
+{
+    // Found offline with the usual search over sparse random numbers,
+    // every one of them works with shift = 64 - bits in the mask
+    constexpr uint64_t rook_magic_numbers[total_squares]{
+        0x0280132180004001, 0x0140001000200040, 0x0880200010000880, 0x2080080005801000,
+        0x0200041020080200, 0x0200041041084200, 0x0400080081124410, 0x2180042100004080,
+        0x8000800099644000, 0x0802003040820100, 0x0105801001862000, 0x0101002008100100,
+        0x1000800400080080, 0x0804800200040080, 0x2001800200800900, 0x00160004088204c1,
+        0x228000c001402000, 0x8510004000200050, 0x3001848020029000, 0x0280808010000801,
+        0x0109010010040800, 0x8000808004000200, 0x8000040081021028, 0x40040a0009004884,
+        0x80c0004280008035, 0x0010004040002000, 0x1101200500410070, 0x8410100080080080,
+        0x000c080080800400, 0x4012008080040002, 0x4000040101000200, 0x0061010200008044,
+        0x0080804010800020, 0x3000201008400040, 0x4112008012002444, 0x0848000880801000,
+        0x00a8008008800400, 0x200200280a00500c, 0x080a221024004801, 0xc400008042000104,
+        0x8000400080028022, 0x0220008040018020, 0x4000200011010040, 0x10060040210a0010,
+        0x40820020904a0004, 0x0030040002008080, 0x0200020801840010, 0x0084c04100820004,
+        0x4802010080c2a600, 0x0000400080201880, 0x2040801000200080, 0x0180200842001200,
+        0x0013510008000500, 0x0182000c00808a80, 0x1000524821302400, 0x3800040108488200,
+        0x104a004810210082, 0x0004210010420082, 0xc424110008200241, 0x90101000a0088501,
+        0x0182000420100802, 0x4822001001080402, 0x05d0080090012204, 0x2008140089042846};
+
+    constexpr uint64_t bishop_magic_numbers[total_squares]{
+        0x0420220228022c80, 0x200208010c108000, 0x1004010411040040, 0x12a4040292002440,
+        0x0804042082000850, 0x0802020220010440, 0x800401048260201a, 0x0041010800828800,
+        0x4040641488080104, 0x20002004016e0020, 0x0c2c223a12420042, 0x0100024081020220,
+        0x0383211041025080, 0x08c0030420160600, 0x0c1000510808c00a, 0x40501a0084140280,
+        0x40280040112c0088, 0x4020040908110050, 0x1028001008801412, 0x0104220202020000,
+        0x800a000400940010, 0x0401000200512410, 0x1082012100900408, 0x0101402208440c00,
+        0x00482104c01c1111, 0x0310105008017101, 0x0022010108080020, 0x02300400104010a0,
+        0x1401010011444000, 0x1001020000405020, 0x00010a0804480411, 0x0419220010404400,
+        0x0010020a00200820, 0xa008280909040104, 0x0210209010080020, 0x3006110800040040,
+        0x0800820200440090, 0x0008100421810080, 0x0028060093264800, 0x0a08004088810080,
+        0x3611100290442000, 0x0241081282001001, 0x11081108010d0800, 0x002a102014420800,
+        0x480002600a004500, 0x8001010102000100, 0x2008080810410883, 0x0002080901101022,
+        0x2800942420444080, 0x2000840108024000, 0x0000804844100040, 0x1444120020884540,
+        0x0004001002020c00, 0x041041c801010049, 0x0060045000850810, 0x1003240c14820208,
+        0x3010104a10100800, 0x0280020101580200, 0x1000000101081600, 0x0644009800420200,
+        0x0050040008102402, 0x00000004601c8106, 0x00088530040812a0, 0x800218010102020c};
+
+    // 102400 rook and 5248 bishop entries, the sum of 2^(bits in the mask) over all squares
+    constexpr int total_slider_attacks = 102400 + 5248;
+
+    uint64_t pext_table[total_slider_attacks];
+
+    // Squares reachable from every square in each direction on an empty board,
+    // the first four run towards higher squares and the last four towards lower
+    uint64_t rays[8][total_squares];
+
+    constexpr int rook_directions[4]{0, 1, 4, 5};
+    constexpr int bishop_directions[4]{2, 3, 6, 7};
+
+    void init_rays()
+    {
+        constexpr int steps[8][2]{{0, 1}, {1, 0}, {1, 1}, {-1, 1}, {0, -1}, {-1, 0}, {-1, -1}, {1, -1}};
+
+        for (int direction = 0; direction < 8; direction++)
+        {
+            for (int sq = 0; sq < total_squares; sq++)
+            {
+                int file = sq % 8 + steps[direction][0];
+                int rank = sq / 8 + steps[direction][1];
+
+                for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += steps[direction][0], rank += steps[direction][1])
+                    rays[direction][sq] |= 1ull << (rank * 8 + file);
+            }
+        }
+    }
+
+    // Each ray is cut after the first blocker, found with a
+    // forward or reverse bitscan depending on the direction
+    uint64_t sliding_attacks(int sq, uint64_t occupancy, const int *directions)
+    {
+        uint64_t attacks = 0;
+
+        for (int i = 0; i < 4; i++)
+        {
+            int direction = directions[i];
+            uint64_t ray = rays[direction][sq];
+            uint64_t blockers = ray & occupancy;
+
+            if (blockers)
+                ray ^= rays[direction][direction < 4 ? __builtin_ctzll(blockers) : 63 - __builtin_clzll(blockers)];
+
+            attacks |= ray;
+        }
+        return attacks;
+    }
+
+    // Blockers that matter, the edge square of a ray is attacked either way
+    uint64_t relevant_mask(int sq, const int *directions)
+    {
+        uint64_t mask = 0;
+
+        for (int i = 0; i < 4; i++)
+        {
+            uint64_t ray = rays[directions[i]][sq];
+            int edge = directions[i] < 4 ? 63 - __builtin_clzll(ray | 1) : __builtin_ctzll(ray | (1ull << 63));
+            mask |= ray & ~(1ull << edge);
+        }
+        return mask;
+    }
+
+    uint32_t init_magics(Attacks::Magic *magics, const uint64_t *magic_numbers, const int *directions, uint32_t offset)
+    {
+        for (int sq = 0; sq < total_squares; sq++)
+        {
+            Attacks::Magic &magic = magics[sq];
+
+            magic.mask = relevant_mask(sq, directions);
+            magic.magic = magic_numbers[sq];
+            magic.shift = 64 - popcount64(magic.mask);
+            magic.offset = offset;
+
+            // Walk every subset of the mask with the carry rippler
+            uint64_t subset = 0;
+            do
+            {
+                Attacks::slider_attacks[magic.index(subset)] = sliding_attacks(sq, subset, directions);
+                subset = (subset - magic.mask) & magic.mask;
+            } while (subset);
+
+            offset += 1u << popcount64(magic.mask);
+        }
+        return offset;
+    }
+
+    // The carry rippler visits the subsets of a mask in the
+    // order of their pext index, 0, 1, 2 and so on
+    uint64_t *init_pext(uint64_t const **table, Attacks::Magic const *magics, const int *directions, uint64_t *entry)
+    {
+        for (int sq = 0; sq < total_squares; sq++)
+        {
+            uint64_t mask = magics[sq].mask;
+            uint64_t subset = 0;
+
+            table[sq] = entry;
+            do
+            {
+                *entry++ = sliding_attacks(sq, subset, directions);
+                subset = (subset - mask) & mask;
+            } while (subset);
+        }
+        return entry;
+    }
+}
+
+namespace Attacks
+{
+    Magic bishop_magics[total_squares];
+    Magic rook_magics[total_squares];
+    uint64_t slider_attacks[total_slider_attacks];
+
+    namespace Pext
+    {
+        uint64_t const *bishop_attacks[total_squares];
+        uint64_t const *rook_attacks[total_squares];
+
+        void init()
+        {
+            uint64_t *entry = init_pext(rook_attacks, rook_magics, rook_directions, pext_table);
+            init_pext(bishop_attacks, bishop_magics, bishop_directions, entry);
+        }
+    }
+
+    void init()
+    {
+        init_rays();
+
+        uint32_t offset = init_magics(rook_magics, rook_magic_numbers, rook_directions, 0);
+        init_magics(bishop_magics, bishop_magic_numbers, bishop_directions, offset);
+
+#ifdef USE_PEXT
+        Pext::init();
+#endif
+    }
+}
@@ -17,17 +17,47 @@
 */
 #pragma once
 #include "position.h"
-#include "magicmoves.hpp"
+
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
 
 namespace Attacks
 {
-    // Initializes magic bitboard arrays. Should be called before
-    // using Attacks::bishop / Attacks::rook
-    inline void init()
+    // Fancy magics, everything a lookup needs for one square. The attacks of
+    // all bishop and rook blocker subsets share the slider_attacks array
+    struct alignas(32) Magic
     {
-        initmagicmoves();
+        uint64_t mask;
+        uint64_t magic;
+        uint32_t offset;
+        uint32_t shift;
+
+        uint32_t index(uint64_t occupancy) const
+        {
+            return offset + uint32_t(((occupancy & mask) * magic) >> shift);
+        }
+    };
+
+    extern Magic bishop_magics[total_squares];
+    extern Magic rook_magics[total_squares];
+    extern uint64_t slider_attacks[];
+
+    // Slider attacks for every subset of a square's relevant blockers, indexed
+    // by pext of the occupancy with the magic masks. Used by ARCH=bmi2 builds,
+    // pext is microcoded and slower than magics on AMD before Zen 3
+    namespace Pext
+    {
+        extern uint64_t const *bishop_attacks[total_squares];
+        extern uint64_t const *rook_attacks[total_squares];
+
+        void init();
     }
 
+    // Fills the slider attack tables. Should be called before
+    // using Attacks::bishop / Attacks::rook
+    void init();
+
     // Return a bitboard of the knight attacks for a
     // knight situated on the given square
     inline uint64_t knight(Square sq)
@@ -47,7 +77,11 @@ namespace Attacks
     // Diagonal and anti-diagonal attacks with respect to the current occupancy
     inline uint64_t bishop(Square sq, uint64_t occ)
     {
-        return Bmagic(sq, occ);
+#ifdef USE_PEXT
+        return Pext::bishop_attacks[sq][_pext_u64(occ, bishop_magics[sq].mask)];
+#else
+        return slider_attacks[bishop_magics[sq].index(occ)];
+#endif
     }
 
     // Return a bitboard of the rook attacks for a
@@ -55,7 +89,11 @@ namespace Attacks
     // Vertical (file) and horizontal(rank) attacks with respect to the current occupancy
     inline uint64_t rook(Square sq, uint64_t occ)
     {
-        return Rmagic(sq, occ);
+#ifdef USE_PEXT
+        return Pext::rook_attacks[sq][_pext_u64(occ, rook_magics[sq].mask)];
+#else
+        return slider_attacks[rook_magics[sq].index(occ)];
+#endif
     }
 
     // Return a bitboard of the queen attacks for a
@@ -65,7 +103,7 @@ namespace Attacks
     // Vertical (file) and horizontal(rank) attacks with respect to the current occupancy
     inline uint64_t queen(Square sq, uint64_t occ)
     {
-        return Qmagic(sq, occ);
+        return bishop(sq, occ) | rook(sq, occ);
     }
 
     // Check whether the given square is directly attacked by any of the given color's
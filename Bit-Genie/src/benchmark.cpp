@@ -19,7 +19,15 @@
 #include "position.h"
 #include "stopwatch.h"
 #include "search.h"
+#include "tt.h"
+#include "eval.h"
+#include "simd.h"
+#include "attacks.h"
+#include <cstdlib>
 #include <iomanip>
+#include <numeric>
+#include <random>
+#include <thread>
 
 // Benchmark positions from Halogen
 const std::array<std::string, 35> benchmark_fens = {
@@ -59,26 +67,90 @@ const std::array<std::string, 35> benchmark_fens = {
     "3Qb1k1/1r2ppb1/pN1n2q1/Pp1Pp1Pr/4P2p/4BP2/4B1R1/1R5K b - - 11 40",
     "4k3/3q1r2/1N2r1b1/3ppN2/2nPP3/1B1R2n1/2R1Q3/3K4 w - - 5 1"};
 
+namespace
+{
+    struct SliderQuery
+    {
+        Square sq;
+        uint64_t occupancy;
+    };
+
+    uint64_t magic_lookups(std::vector<SliderQuery> const &queries, int rounds)
+    {
+        uint64_t sum = 0;
+        for (int round = 0; round < rounds; round++)
+        {
+            for (auto const &query : queries)
+            {
+                sum += Attacks::slider_attacks[Attacks::bishop_magics[query.sq].index(query.occupancy)] ^
+                       Attacks::slider_attacks[Attacks::rook_magics[query.sq].index(query.occupancy)];
+            }
+        }
+        return sum;
+    }
+
+    // Built for bmi2 whatever the target, only called when the cpu has it
+    __attribute__((target("bmi2"))) uint64_t pext_lookups(std::vector<SliderQuery> const &queries, int rounds)
+    {
+        using namespace Attacks::Pext;
+
+        uint64_t sum = 0;
+        for (int round = 0; round < rounds; round++)
+        {
+            for (auto const &query : queries)
+            {
+                sum += bishop_attacks[query.sq][__builtin_ia32_pext_di(query.occupancy, Attacks::bishop_magics[query.sq].mask)] ^
+                       rook_attacks[query.sq][__builtin_ia32_pext_di(query.occupancy, Attacks::rook_magics[query.sq].mask)];
+            }
+        }
+        return sum;
+    }
+
+    // Everything ttstress stores for a key is derived from the key,
+    // so any entry read back can be checked field by field
+    TEntry stress_payload(uint64_t key)
+    {
+        uint64_t mix = key * 0x9e3779b97f4a7c15ull;
+
+        int16_t score = int16_t(int((mix >> 20) & 0x3fff) - 0x2000);
+        Move move = Move(uint16_t(mix >> 36) | 1);
+        uint8_t depth = uint8_t(1 + (mix >> 58));
+        TEFlag flag = TEFlag(1 + (mix >> 40) % 3);
+
+        return TEntry(score, move, depth, flag);
+    }
+}
+
 namespace BenchMark
 {
-    // Benchmark a perft test and print out the nodes and time taken
-    void perft(Position &position, int depth)
+    // Benchmark a perft test and print out the nodes below
+    // every root move, the total and the time taken
+    void perft(Position const &position, Perft::Options const &options)
     {
-        uint64_t nodes = 0;
+        if (options.depth < 1)
+            return;
+
         StopWatch<> watch;
         watch.go();
-        position.perft(depth, nodes);
+        auto divide = Perft::divide(position, options);
         watch.stop();
 
+        uint64_t nodes = 0;
+        for (auto const &[move, count] : divide)
+        {
+            std::cout << print_move(move) << ": " << count << std::endl;
+            nodes += count;
+        }
+
         long long elapsed = std::max(1ll, static_cast<long long>((watch.elapsed_time()).count()));
         double elapsed_seconds = elapsed / 1000.0f;
 
         std::cout << "\nnodes: " << nodes;
         std::cout << "\ttime: " << std::setprecision(2) << std::fixed << elapsed_seconds << " seconds";
-        
+
         if (elapsed_seconds >= 1)
             std::cout << "\tnps: " << int(nodes / elapsed_seconds);
-        
+
         std::cout << std::endl;
     }
 
@@ -86,6 +158,10 @@ namespace BenchMark
     // position. Print out the total nodes search and the nodes per second ( nodes / time)
     void bench(Position position, TTable &tt) // copy on purpose
     {
+        EvalCacheStats &stats = eval_cache_stats();
+        stats = EvalCacheStats();
+        clear_eval_cache();
+
         StopWatch<> watch;
         watch.go();
         uint64_t nodes = 0;
@@ -103,6 +179,11 @@ namespace BenchMark
         }
         watch.stop();
 
+        std::cout << "Pawn hash hits: " << std::setprecision(2) << std::fixed
+                  << 100.0 * stats.pawn_hits / std::max<uint64_t>(1, stats.pawn_probes) << "%" << std::endl;
+        std::cout << "Material hash hits: " << 100.0 * stats.material_hits / std::max<uint64_t>(1, stats.material_probes) << "%" << std::endl;
+        std::cout << "Eval cache hits: " << 100.0 * stats.eval_hits / std::max<uint64_t>(1, stats.eval_probes) << "%" << std::endl;
+        std::cout << "Lazy evaluations: " << 100.0 * stats.lazy_exits / std::max<uint64_t>(1, stats.eval_probes) << "%" << std::endl;
         std::cout << "Time elapsed: " << watch.elapsed_time().count() / 1000.0f << std::endl;
 
         auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(watch.elapsed_time()).count();
@@ -110,4 +191,298 @@ namespace BenchMark
 
         std::cout << nodes << " nodes " << int((nodes / elapsed)) << " nps" << std::endl;
     }
+
+    // Time random probes into the transposition table. With small tables the
+    // buckets stay in cache and this mostly measures the index computation
+    void hash_probe(TTable const &tt)
+    {
+        constexpr int total_keys = 1 << 16;
+        constexpr int total_probes = 1 << 24;
+
+        std::mt19937_64 gen(0);
+        std::vector<uint64_t> keys(total_keys);
+        for (auto &key : keys)
+            key = gen();
+
+        StopWatch<std::chrono::nanoseconds> watch;
+        watch.go();
+
+        uint64_t hits = 0;
+        TEntry entry;
+        for (int i = 0; i < total_probes; i++)
+            hits += tt.retrieve(keys[i & (total_keys - 1)], entry, 0);
+
+        watch.stop();
+
+        double ns = double(watch.elapsed_time().count()) / total_probes;
+        std::cout << total_probes << " probes " << std::setprecision(2) << std::fixed << ns << " ns/probe";
+        std::cout << " (" << hits << " hits)" << std::endl;
+    }
+
+    // Hammer a small table from several threads with keys that all land in
+    // 64 buckets, and check that every entry retrieve() accepts
+    // is exactly what was stored for that key, not a mix of two writes
+    void tt_stress(int threads)
+    {
+        constexpr int total_keys = 1 << 12;
+        constexpr int total_buckets = 64;
+        constexpr int ops_per_thread = 1 << 22;
+
+        TTable tt(1);
+        std::mt19937_64 gen(0);
+
+        // The top bits pick the bucket, the low bits are the key's index so no
+        // two keys share the verification bits and a hit is never a false one
+        uint64_t bucket_bits[total_buckets];
+        for (auto &bits : bucket_bits)
+            bits = gen() & 0xffff000000000000ull;
+
+        std::vector<uint64_t> keys(total_keys);
+        for (int i = 0; i < total_keys; i++)
+            keys[i] = bucket_bits[i % total_buckets] | (gen() & 0x0000ffffffff0000ull) | uint64_t(i);
+
+        std::vector<uint64_t> hits(threads, 0), corrupted(threads, 0);
+
+        auto worker = [&](int thread) {
+            std::mt19937_64 rng(thread + 1);
+            TEntry entry;
+
+            for (int i = 0; i < ops_per_thread; i++)
+            {
+                uint64_t key = keys[rng() % total_keys];
+                TEntry expected = stress_payload(key);
+
+                if (rng() & 1)
+                {
+                    tt.add(key, Move(expected.move), expected.score, expected.depth, expected.flag, 0);
+                    continue;
+                }
+
+                if (!tt.retrieve(key, entry, 0))
+                    continue;
+
+                hits[thread]++;
+                corrupted[thread] += entry.move != expected.move || entry.score != expected.score ||
+                                     entry.depth != expected.depth || entry.flag != expected.flag;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threads; i++)
+            workers.emplace_back(worker, i);
+
+        for (auto &thread : workers)
+            thread.join();
+
+        uint64_t total_hits = std::accumulate(hits.begin(), hits.end(), uint64_t(0));
+        uint64_t total_corrupted = std::accumulate(corrupted.begin(), corrupted.end(), uint64_t(0));
+
+        std::cout << threads << " threads " << uint64_t(threads) * ops_per_thread << " operations ";
+        std::cout << total_hits << " hits " << total_corrupted << " corrupted" << std::endl;
+        std::cout << (total_hits && !total_corrupted ? "pass" : "fail") << std::endl;
+    }
+
+    // Search positions with a known distance to mate and check the mate reported
+    // by every iteration. The king and queen/rook endings reach the same positions
+    // through many move orders, so their mate scores come back from the table at
+    // other plies than they were stored at
+    void mate_check()
+    {
+        struct MateTest
+        {
+            char const *fen;
+            int mate;
+            int depth;
+        };
+
+        constexpr MateTest tests[]{
+            {"kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1", 2, 14},
+            {"kbK5/pp6/RP6/8/8/8/8/8 b - - 1 1", -1, 12},
+            {"r5rk/5p1p/5R2/4B3/8/8/7P/7K w - - 0 1", 3, 14},
+            {"r5rk/5p1p/R7/4B3/8/8/7P/7K b - - 1 1", -2, 14},
+            {"8/8/8/4k3/8/8/8/KQ6 w - - 0 1", 9, 28},
+            {"8/8/8/8/4k3/8/8/R3K3 w - - 0 1", 13, 32}};
+
+        bool passed = true;
+        for (auto const &test : tests)
+        {
+            Position position;
+            position.set_fen(test.fen);
+
+            TTable tt(16);
+            std::vector<int> scores = search_scores(position, tt, test.depth);
+
+            // Shallow iterations may find a longer mate, never a shorter one,
+            // and once the right distance shows up it has to stay
+            int found = 0;
+            for (int depth = 1; depth <= test.depth; depth++)
+            {
+                int score = scores[depth - 1];
+                int mate = std::abs(score) > MinMateScore ? mate_distance(score) : 0;
+                bool wrong = mate && ((mate > 0) != (test.mate > 0) || std::abs(mate) < std::abs(test.mate));
+
+                if (wrong || (found && mate != test.mate) || (depth == test.depth && mate != test.mate))
+                {
+                    std::cout << test.fen << ": depth " << depth << " reported mate " << mate
+                              << ", expected mate " << test.mate << std::endl;
+                    passed = false;
+                    found = -1;
+                    break;
+                }
+
+                if (!found && mate == test.mate)
+                    found = depth;
+            }
+
+            if (found > 0)
+                std::cout << test.fen << ": mate " << test.mate << " from depth " << found << " to " << test.depth << std::endl;
+        }
+        std::cout << (passed ? "pass" : "fail") << std::endl;
+    }
+
+    // Check every kernel the cpu supports against the scalar
+    // version, then time them on network sized inputs
+    void simd()
+    {
+        using namespace SIMD;
+
+        constexpr int max_size = 1024;
+        constexpr int total_calls = 1 << 22;
+
+        std::mt19937_64 gen(0);
+        std::vector<int16_t> values(max_size), weights16(max_size), expected(max_size);
+        std::vector<uint8_t> input(max_size);
+        std::vector<int8_t> weights8(max_size), layer(512 * 32);
+        std::vector<int32_t> bias(32), tested_out(32), reference_out(32);
+
+        for (int i = 0; i < max_size; i++)
+        {
+            values[i] = int16_t(gen() % 2001) - 1000;
+            weights16[i] = int16_t(gen() % 2001) - 1000;
+            input[i] = uint8_t(gen() % 128);
+            weights8[i] = int8_t(gen() % 256 - 128);
+        }
+
+        for (int i = 0; i < 512 * 32; i++)
+            layer[i] = int8_t(gen() % 256 - 128);
+
+        for (auto &value : bias)
+            value = int32_t(gen() % 2001) - 1000;
+
+        Kernels const &reference = get(Level::scalar);
+        std::cout << "detected " << kernels.name << std::endl;
+
+        for (int level = 0; level <= to_int(detect()); level++)
+        {
+            Kernels const &tested = get(Level(level));
+            bool correct = true;
+
+            // Odd sizes and offsets exercise the scalar tails
+            for (int size = 0; size <= 600; size += 1 + size / 8)
+            {
+                int offset = size % 3;
+                std::vector<int16_t> result(values);
+                std::copy(values.begin(), values.end(), expected.begin());
+
+                tested.add(&result[offset], &weights16[offset], size);
+                reference.add(&expected[offset], &weights16[offset], size);
+                tested.sub(&result[offset], &weights16[1], size);
+                reference.sub(&expected[offset], &weights16[1], size);
+
+                correct &= result == expected;
+                correct &= tested.dot(&input[offset], &weights8[1], size) == reference.dot(&input[offset], &weights8[1], size);
+            }
+
+            for (int size : {1, 32, 100, 512})
+            {
+                for (int outputs : {1, 6, 32})
+                {
+                    tested.affine(input.data(), layer.data(), bias.data(), tested_out.data(), size, outputs);
+                    reference.affine(input.data(), layer.data(), bias.data(), reference_out.data(), size, outputs);
+                    correct &= std::equal(tested_out.begin(), tested_out.begin() + outputs, reference_out.begin());
+                }
+            }
+
+            StopWatch<std::chrono::nanoseconds> watch;
+            watch.go();
+
+            for (int i = 0; i < total_calls; i++)
+            {
+                int row = (i & 3) * 256;
+                tested.add(values.data(), &weights16[row], 256);
+                tested.sub(values.data(), &weights16[row ^ 256], 256);
+            }
+
+            watch.stop();
+            double update = double(watch.elapsed_time().count()) / total_calls;
+
+            // A 512 x 32 layer per call, the size of the first hidden layer
+            watch.reset();
+            watch.go();
+
+            for (int i = 0; i < total_calls / 32; i++)
+                tested.affine(input.data(), layer.data(), bias.data(), tested_out.data(), 512, 32);
+
+            watch.stop();
+            double layer_ns = double(watch.elapsed_time().count()) / (total_calls / 32);
+
+            std::cout << std::setw(8) << tested.name << (correct ? "  ok  " : "  FAIL  ") << std::setprecision(2) << std::fixed
+                      << update << " ns/update " << layer_ns << " ns/layer" << std::endl;
+        }
+    }
+
+    // Time bishop + rook lookups on random occupancies with both slider
+    // backends, then perft with the one this binary was built with
+    void attacks()
+    {
+        constexpr int total_queries = 1 << 12;
+        constexpr int rounds = 1 << 10;
+
+        std::mt19937_64 gen(0);
+        std::vector<SliderQuery> queries(total_queries);
+        for (auto &query : queries)
+            query = {Square(gen() % total_squares), gen() & gen()};
+
+        auto report = [&](char const *name, auto lookups) {
+            StopWatch<std::chrono::nanoseconds> watch;
+            watch.go();
+            uint64_t sum = lookups(queries, rounds);
+            watch.stop();
+
+            double ns = double(watch.elapsed_time().count()) / (double(total_queries) * rounds);
+            std::cout << std::setw(6) << name << "  " << std::setprecision(2) << std::fixed << ns
+                      << " ns/lookup (" << sum % 1000 << ")" << std::endl;
+        };
+
+        report("magic", magic_lookups);
+
+        if (__builtin_cpu_supports("bmi2"))
+        {
+            if (!Attacks::Pext::rook_attacks[0])
+                Attacks::Pext::init();
+
+            bool correct = true;
+            for (auto const &query : queries)
+                correct &= pext_lookups({query}, 1) == magic_lookups({query}, 1);
+
+            std::cout << (correct ? "pext tables match the magics" : "pext tables DON'T match the magics") << std::endl;
+            report("pext", pext_lookups);
+        }
+        else
+            std::cout << "no bmi2 on this cpu" << std::endl;
+
+        Position position;
+        uint64_t nodes = 0;
+        StopWatch<std::chrono::nanoseconds> watch;
+        watch.go();
+        position.perft(6, nodes, false);
+        watch.stop();
+
+#ifdef USE_PEXT
+        std::cout << "perft 6 with pext: ";
+#else
+        std::cout << "perft 6 with magics: ";
+#endif
+        std::cout << nodes << " nodes " << int(nodes * 1e9 / watch.elapsed_time().count()) << " nps" << std::endl;
+    }
 }
\ No newline at end of file
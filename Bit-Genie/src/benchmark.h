@@ -17,9 +17,15 @@
 */
 #pragma once
 #include "misc.h"
+#include "perft.h"
 
 namespace BenchMark
 {
-    void perft(Position &, int depth);
+    void perft(Position const &, Perft::Options const &);
     void bench(Position, TTable &);
+    void hash_probe(TTable const &);
+    void tt_stress(int threads);
+    void mate_check();
+    void simd();
+    void attacks();
 }
\ No newline at end of file
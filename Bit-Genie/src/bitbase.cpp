@@ -0,0 +1,162 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "bitbase.h"
+#include "bitboard.h"
+#include "piece.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    // Pawns on files a-d and ranks 2-7, the rest is mirrored
+    constexpr int total_positions = 2 * 24 * total_squares * total_squares;
+
+    enum Result : uint8_t
+    {
+        invalid = 0,
+        unknown = 1,
+        draw = 2,
+        win = 4
+    };
+
+    uint32_t table[total_positions / 32];
+
+    int rank_of(int sq)
+    {
+        return sq >> 3;
+    }
+
+    int file_of(int sq)
+    {
+        return sq & 7;
+    }
+
+    int distance(int a, int b)
+    {
+        int files = file_of(a) - file_of(b);
+        int ranks = rank_of(a) - rank_of(b);
+        return std::max(files < 0 ? -files : files, ranks < 0 ? -ranks : ranks);
+    }
+
+    int index(Color side, int strong_king, int weak_king, int pawn)
+    {
+        return strong_king | (weak_king << 6) | (side << 12) | (file_of(pawn) << 13) | ((6 - rank_of(pawn)) << 15);
+    }
+
+    struct Entry
+    {
+        Color side;
+        int kings[total_colors];
+        int pawn;
+        Result result;
+
+        explicit Entry(int idx)
+        {
+            kings[White] = idx & 63;
+            kings[Black] = (idx >> 6) & 63;
+            side = Color((idx >> 12) & 1);
+            pawn = ((idx >> 13) & 3) + (6 - (idx >> 15)) * 8;
+
+            uint64_t pawn_attacks = BitMask::pawn_attacks[White][pawn];
+            int push = pawn + 8;
+
+            if (distance(kings[White], kings[Black]) <= 1 || kings[White] == pawn || kings[Black] == pawn 
+             || (side == White && (pawn_attacks & (1ull << kings[Black]))))
+                result = invalid;
+
+            // The pawn promotes and can't be taken
+            else if (side == White && rank_of(pawn) == 6 && kings[White] != push 
+                  && (distance(kings[Black], push) > 1 || distance(kings[White], push) == 1))
+                result = win;
+
+            // Stalemate, or the pawn is taken
+            else if (side == Black && (!(BitMask::king_attacks[kings[Black]] & ~(BitMask::king_attacks[kings[White]] | pawn_attacks)) 
+                  || (BitMask::king_attacks[kings[Black]] & (1ull << pawn) & ~BitMask::king_attacks[kings[White]])))
+                result = draw;
+
+            else
+                result = unknown;
+        }
+
+        // A position is won if white has a move to a won position or all
+        // of black's moves lead to one, and drawn the other way around
+        Result classify(std::vector<Entry> const &db) const
+        {
+            Result good = side == White ? win : draw;
+            Result bad = side == White ? draw : win;
+
+            int r = invalid;
+            uint64_t moves = BitMask::king_attacks[kings[side]];
+
+            while (moves)
+            {
+                int to = pop_lsb(moves);
+                r |= side == White ? db[index(Black, to, kings[Black], pawn)].result 
+                                   : db[index(White, kings[White], to, pawn)].result;
+            }
+
+            if (side == White)
+            {
+                if (rank_of(pawn) < 6)
+                    r |= db[index(Black, kings[White], kings[Black], pawn + 8)].result;
+
+                if (rank_of(pawn) == 1 && pawn + 8 != kings[White] && pawn + 8 != kings[Black])
+                    r |= db[index(Black, kings[White], kings[Black], pawn + 16)].result;
+            }
+
+            return (r & good) ? good : (r & unknown) ? unknown : bad;
+        }
+    };
+}
+
+namespace KPK
+{
+    void init()
+    {
+        std::vector<Entry> db;
+        db.reserve(total_positions);
+
+        for (int idx = 0; idx < total_positions; idx++)
+            db.emplace_back(idx);
+
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (auto &entry : db)
+            {
+                if (entry.result == unknown && (entry.result = entry.classify(db)) != unknown)
+                    changed = true;
+            }
+        }
+
+        for (int idx = 0; idx < total_positions; idx++)
+        {
+            if (db[idx].result == win)
+                table[idx / 32] |= 1u << (idx & 31);
+        }
+    }
+
+    bool is_win(Square strong_king, Square pawn, Square weak_king, Color side_to_move)
+    {
+        // Mirror the pawn onto the queen side
+        int mirror = file_of(pawn) >= 4 ? 7 : 0;
+        int idx = index(side_to_move, strong_king ^ mirror, weak_king ^ mirror, pawn ^ mirror);
+        return table[idx / 32] & (1u << (idx & 31));
+    }
+}
@@ -44,6 +44,8 @@ namespace BitMask
 	constexpr uint64_t rank7 = rank6 << 8;
 	constexpr uint64_t rank8 = rank7 << 8;
 
+	constexpr uint64_t dark_squares = 0xAA55AA55AA55AA55;
+
 	constexpr uint64_t knight_attacks[total_squares]{
 	  0X0000000000020400,  0X0000000000050800,  0X00000000000a1100,  0X0000000000142200,
 	  0X0000000000284400,  0X0000000000508800,  0X0000000000a01000,  0X0000000000402000,
@@ -188,5 +190,62 @@ namespace BitMask
 	  0X04040404040404040, 0X00202020202020202, 0X00505050505050505, 0X00a0a0a0a0a0a0a0a, 0X01414141414141414,
 	  0X02828282828282828, 0X05050505050505050, 0X0a0a0a0a0a0a0a0a0, 0X04040404040404040
 	};
+	// Squares strictly between two squares sharing a rank, file or diagonal,
+	// and the whole line through them. Both are empty when they don't
+	struct Rays
+	{
+		uint64_t between[total_squares][total_squares];
+		uint64_t line[total_squares][total_squares];
+	};
+
+	constexpr Rays make_rays()
+	{
+		Rays rays{};
+		constexpr int steps[4][2]{{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+
+		for (int from = 0; from < total_squares; from++)
+		{
+			for (auto const &step : steps)
+			{
+				uint64_t line = 1ull << from;
+
+				for (int sign : {1, -1})
+				{
+					int file = from % 8 + step[0] * sign;
+					int rank = from / 8 + step[1] * sign;
+
+					for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += step[0] * sign, rank += step[1] * sign)
+						line |= 1ull << (rank * 8 + file);
+				}
+
+				for (int sign : {1, -1})
+				{
+					uint64_t path = 0;
+					int file = from % 8 + step[0] * sign;
+					int rank = from / 8 + step[1] * sign;
+
+					for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += step[0] * sign, rank += step[1] * sign)
+					{
+						int to = rank * 8 + file;
+						rays.between[from][to] = path;
+						rays.line[from][to] = line;
+						path |= 1ull << to;
+					}
+				}
+			}
+		}
+		return rays;
+	}
+
+	inline constexpr Rays rays = make_rays();
+
+	inline uint64_t between(int from, int to)
+	{
+		return rays.between[from][to];
+	}
 
+	inline uint64_t line(int from, int to)
+	{
+		return rays.line[from][to];
+	}
 }
\ No newline at end of file
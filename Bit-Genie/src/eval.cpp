@@ -21,7 +21,13 @@
 #include "attacks.h"
 #include "board.h"
 #include "evalscores.h"
+#include "nnue.h"
+#include "evaltrace.h"
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <math.h>
 
 struct EvalData
@@ -31,11 +37,24 @@ struct EvalData
     uint64_t king_ring[2] = {0};
     int attackers_count[2];
 
+    // Enemy pawn attacks are needed by every knight, computed
+    // once here instead of per piece
+    uint64_t pawn_attacks[2];
+
+    EvalTrace *trace;
+
     void init(Position const &position)
     {
         std::memset(this, 0, sizeof(EvalData));
         king_ring[White] = Attacks::king(get_lsb(position.pieces.get_piece_bb<King>(White)));
         king_ring[Black] = Attacks::king(get_lsb(position.pieces.get_piece_bb<King>(Black)));
+
+        for (Color color : {White, Black})
+        {
+            uint64_t pawns = position.pieces.get_piece_bb<Pawn>(color);
+            uint64_t forward = color == White ? shift<Direction::north>(pawns) : shift<Direction::south>(pawns);
+            pawn_attacks[color] = shift<Direction::east>(forward) | shift<Direction::west>(forward);
+        }
     }
     void update_attackers_count(uint64_t attacks, Color by)
     {
@@ -43,7 +62,13 @@ struct EvalData
     }
 };
 
-template <PieceType pt, bool safe = false>
+template <PieceType pt>
+static constexpr Trace::Term mobility_term = pt == Knight ? Trace::KnightEval_mobility
+                                           : pt == Bishop ? Trace::BishopEval_mobility
+                                           : pt == Rook   ? Trace::RookEval_mobility
+                                                          : Trace::QueenEval_mobility;
+
+template <bool trace, PieceType pt, bool safe = false>
 static constexpr int calculate_moblity(Position const &position, EvalData &data, Square sq, Color us, const int *mobility_scores)
 {
     uint64_t occupancy = position.total_occupancy();
@@ -58,13 +83,15 @@ static constexpr int calculate_moblity(Position const &position, EvalData &data,
             data.king_attackers_weight[us] += KingEval::attack_weight[pt] * popcount64(attacks & data.king_ring[!us]);
             data.king_attackers_count[us]++;
         }
+
+        if constexpr (trace)
+            data.trace->coeffs[mobility_term<pt> + popcount64(attacks)][us]++;
+
         return mobility_scores[popcount64(attacks)];
     }
     else
     {
-        uint64_t enemy_pawns = position.pieces.get_piece_bb<Pawn>(!us);
-        uint64_t forward = us == White ? shift<Direction::south>(enemy_pawns) : shift<Direction::north>(enemy_pawns);
-        uint64_t enemy_pawn_attacks = shift<Direction::east>(forward) | shift<Direction::west>(forward);
+        uint64_t enemy_pawn_attacks = data.pawn_attacks[!us];
 
         if (attacks & data.king_ring[!us])
         {
@@ -72,53 +99,11 @@ static constexpr int calculate_moblity(Position const &position, EvalData &data,
             data.king_attackers_count[us]++;
         }
 
-        return mobility_scores[popcount64(attacks & ~enemy_pawn_attacks)];
-    }
-}
-
-static bool material_draw(Position const &position)
-{
-    auto single = [](uint64_t bb)
-    { return bb && !is_several(bb); };
-
-    auto &pieces = position.pieces;
-    auto &bitboards = position.pieces.bitboards;
-
-    if (bitboards[Pawn] || bitboards[Queen])
-        return false;
-
-    if (!bitboards[Rook])
-    {
-        if (!bitboards[Bishop])
-        {
-            uint64_t white = pieces.get_piece_bb<Knight>(White);
-            uint64_t black = pieces.get_piece_bb<Knight>(Black);
-
-            return popcount64(black) <= 2 && popcount64(white) <= 2;
-        }
-
-        if (!bitboards[Knight])
-        {
-            uint64_t white = pieces.get_piece_bb<Bishop>(White);
-            uint64_t black = pieces.get_piece_bb<Bishop>(Black);
+        if constexpr (trace)
+            data.trace->coeffs[mobility_term<pt> + popcount64(attacks & ~enemy_pawn_attacks)][us]++;
 
-            return abs(popcount64(white) - popcount64(black)) <= 2;
-        }
-    }
-    else
-    {
-        // Rook vs 2 minors
-        if (single(bitboards[Rook]))
-        {
-            Color owner = pieces.get_piece_bb<Rook>(White) ? White : Black;
-
-            uint64_t minor = bitboards[Bishop] | bitboards[Knight];
-
-            return !(minor & pieces.colors[owner]) && (popcount64(minor & pieces.colors[!owner]) == 1 || popcount64(minor & pieces.colors[!owner]) == 2);
-        }
+        return mobility_scores[popcount64(attacks & ~enemy_pawn_attacks)];
     }
-
-    return false;
 }
 
 static bool pawn_passed(uint64_t enemy_pawns, Color us, Square sq)
@@ -142,45 +127,167 @@ static Square psqt_sq(Square sq, Color color)
     return color == White ? flip_square(sq) : sq;
 }
 
-static int evaluate_pawn(Position const &position, EvalData& data, Square sq, Color us)
+namespace
+{
+    thread_local EvalTables *tables = nullptr;
+    thread_local std::unique_ptr<EvalTables> private_tables;
+
+    int lazy_margin = 500;
+}
+
+void bind_eval_tables(EvalTables &bound)
+{
+    tables = &bound;
+}
+
+EvalTables &eval_tables()
+{
+    if (!tables)
+    {
+        private_tables = std::make_unique<EvalTables>();
+        tables = private_tables.get();
+    }
+    return *tables;
+}
+
+EvalCacheStats &eval_cache_stats()
+{
+    return eval_tables().stats;
+}
+
+void clear_eval_cache()
+{
+    eval_tables().evals.clear();
+}
+
+void set_lazy_margin(int margin)
+{
+    lazy_margin = margin;
+}
+
+// Pawn structure terms, material and piece square
+// scores are kept incrementally by Position
+template <bool trace>
+static int evaluate_pawn_structure(PawnEntry &entry, EvalTrace *tracer, uint64_t friend_pawns, uint64_t enemy_pawns, Square sq, Color us)
 {
     int score = 0;
-    uint64_t enemy_pawns = position.pieces.get_piece_bb<Pawn>(!us);
-    uint64_t friend_pawns = position.pieces.get_piece_bb<Pawn>(us);
-    uint64_t enemy = position.pieces.get_occupancy(!us);
-    uint64_t ahead_squares = BitMask::passed_pawn[us][sq] & BitMask::files[sq];
 
-    data.update_attackers_count(BitMask::pawn_attacks[us][sq], us);
+    entry.attack_count[us] += popcount64(BitMask::pawn_attacks[us][sq]);
 
-    score += PawnEval::psqt[psqt_sq(sq, us)];
     score += pawn_is_isolated(friend_pawns, sq) * PawnEval::isolated;
     score += pawn_is_stacked(friend_pawns, sq) * PawnEval::stacked;
 
-    bool passed = pawn_passed(enemy_pawns, us, sq);
+    if constexpr (trace)
+    {
+        tracer->coeffs[Trace::PawnEval_isolated][us] += pawn_is_isolated(friend_pawns, sq);
+        tracer->coeffs[Trace::PawnEval_stacked][us] += pawn_is_stacked(friend_pawns, sq);
+    }
+
+    if (pawn_passed(enemy_pawns, us, sq))
+    {
+        entry.passed[us] |= 1ull << sq;
+
+        if (BitMask::pawn_attacks[!us][sq] & friend_pawns)
+        {
+            score += PawnEval::passed_connected;
+
+            if constexpr (trace)
+                tracer->coeffs[Trace::PawnEval_passed_connected][us]++;
+        }
+    }
+
+    return score;
+}
+
+template <bool trace>
+static void fill_pawn_entry(Position const &position, PawnEntry &entry, EvalTrace *tracer)
+{
+    uint64_t white = position.pieces.get_piece_bb<Pawn>(White);
+    uint64_t black = position.pieces.get_piece_bb<Pawn>(Black);
+
+    for (uint64_t pawns = white; pawns;)
+        entry.score += evaluate_pawn_structure<trace>(entry, tracer, white, black, pop_lsb(pawns), White);
+
+    for (uint64_t pawns = black; pawns;)
+        entry.score -= evaluate_pawn_structure<trace>(entry, tracer, black, white, pop_lsb(pawns), Black);
+}
+
+static PawnEntry const &probe_pawn_table(Position const &position)
+{
+    uint64_t key = position.pawn_key.data();
+    EvalTables &tables = eval_tables();
+    PawnEntry &entry = tables.pawns.probe(key);
 
-    if (passed)
+    tables.stats.pawn_probes++;
+    if (entry.key == key)
     {
+        tables.stats.pawn_hits++;
+        return entry;
+    }
+
+    entry = PawnEntry();
+    entry.key = key;
+    fill_pawn_entry<false>(position, entry, nullptr);
+
+    return entry;
+}
+
+// Passed pawns are scored on every call since whether
+// they are blocked depends on the other pieces
+template <bool trace>
+static int evaluate_passers(Position const &position, EvalData &data, uint64_t passed, Color us)
+{
+    int score = 0;
+    uint64_t enemy = position.pieces.get_occupancy(!us);
+
+    while (passed)
+    {
+        Square sq = pop_lsb(passed);
+        uint64_t ahead_squares = BitMask::passed_pawn[us][sq] & BitMask::files[sq];
+
         if (ahead_squares & enemy)
             score += PawnEval::passer_blocked[psqt_sq(sq, us)];
-        else 
+        else
             score += PawnEval::passed[psqt_sq(sq, us)];
 
-        if (BitMask::pawn_attacks[!us][sq] & friend_pawns)
-            score += PawnEval::passed_connected;
+        if constexpr (trace)
+        {
+            int term = ahead_squares & enemy ? Trace::PawnEval_passer_blocked : Trace::PawnEval_passed;
+            data.trace->coeffs[term + psqt_sq(sq, us)][us]++;
+        }
     }
 
-    score += PawnEval::value;
+    return score;
+}
+
+// The traced evaluation can't use the pawn table, cached
+// entries don't know which terms they are made of
+template <bool trace>
+static int evaluate_pawns(Position const &position, EvalData &data)
+{
+    PawnEntry traced;
+
+    if constexpr (trace)
+        fill_pawn_entry<true>(position, traced, data.trace);
+
+    PawnEntry const &entry = trace ? traced : probe_pawn_table(position);
+
+    data.attackers_count[White] += entry.attack_count[White];
+    data.attackers_count[Black] += entry.attack_count[Black];
+
+    int score = entry.score;
+    score += evaluate_passers<trace>(position, data, entry.passed[White], White);
+    score -= evaluate_passers<trace>(position, data, entry.passed[Black], Black);
 
     return score;
 }
 
+template <bool trace>
 static int evaluate_knight(Position const &position, EvalData &data, Square sq, Color us)
 {
     int score = 0;
 
-    score += KnightEval::psqt[psqt_sq(sq, us)];
-    score += calculate_moblity<Knight, true>(position, data, sq, us, KnightEval::mobility);
-    score += KnightEval::value;
+    score += calculate_moblity<trace, Knight, true>(position, data, sq, us, KnightEval::mobility);
 
     return score;
 }
@@ -200,37 +307,40 @@ static bool is_on_semiopen_file(Position const &position, Square sq)
     return !(file & white) || !(file & black);
 }
 
+template <bool trace>
 static int evaluate_rook(Position const &position, EvalData &data, Square sq, Color us)
 {
     int score = 0;
 
-    score += RookEval::psqt[psqt_sq(sq, us)];
-    score += calculate_moblity<Rook>(position, data, sq, us, RookEval::mobility);
+    score += calculate_moblity<trace, Rook>(position, data, sq, us, RookEval::mobility);
     score += is_on_open_file(position, sq) * RookEval::open_file;
     score += is_on_semiopen_file(position, sq) * RookEval::semi_open_file;
-    score += RookEval::value;
+
+    if constexpr (trace)
+    {
+        data.trace->coeffs[Trace::RookEval_open_file][us] += is_on_open_file(position, sq);
+        data.trace->coeffs[Trace::RookEval_semi_open_file][us] += is_on_semiopen_file(position, sq);
+    }
 
     return score;
 }
 
+template <bool trace>
 static int evaluate_queen(Position const &position, EvalData &data, Square sq, Color us)
 {
     int score = 0;
 
-    score += QueenEval::psqt[psqt_sq(sq, us)];
-    score += calculate_moblity<Queen>(position, data, sq, us, QueenEval::mobility);
-    score += QueenEval::value;
+    score += calculate_moblity<trace, Queen>(position, data, sq, us, QueenEval::mobility);
 
     return score;
 }
 
+template <bool trace>
 static int evaluate_bishop(Position const &position, EvalData &data, Square sq, Color us)
 {
     int score = 0;
 
-    score += BishopEval::psqt[psqt_sq(sq, us)];
-    score += calculate_moblity<Bishop>(position, data, sq, us, BishopEval::mobility);
-    score += BishopEval::value;
+    score += calculate_moblity<trace, Bishop>(position, data, sq, us, BishopEval::mobility);
 
     return score;
 }
@@ -260,32 +370,12 @@ static int evaluate_piece(Position const &position, EvalData &data, Callable F)
     return score;
 }
 
-static int get_phase(Position const &position)
-{
-    constexpr int rook_phase = 2;
-    constexpr int queen_phase = 4;
-
-    int phase = 19;
-
-    uint64_t knights = position.pieces.bitboards[Knight];
-    uint64_t bishops = position.pieces.bitboards[Bishop];
-    uint64_t rooks = position.pieces.bitboards[Rook];
-    uint64_t queens = position.pieces.bitboards[Queen];
-
-    phase -= popcount64(knights);
-    phase -= popcount64(bishops);
-    phase -= popcount64(queens) * queen_phase;
-    phase -= popcount64(rooks) * rook_phase;
-    phase = (phase * 256 + 12) / 24;
-
-    return phase;
-}
-
+template <bool trace>
 static int eval_king(Position const &position, EvalData &data, Color us)
 {
     Square sq = get_lsb(position.pieces.get_piece_bb<King>(us));
 
-    int score = KingEval::psqt[psqt_sq(sq, us)];
+    int score = 0;
     Color enemy = !us;
 
     data.update_attackers_count(BitMask::king_attacks[sq], us);
@@ -298,48 +388,255 @@ static int eval_king(Position const &position, EvalData &data, Color us)
             weight /= 2;
 
         score += KingEval::safety_table[weight];
+
+        if constexpr (trace)
+            data.trace->coeffs[Trace::KingEval_safety_table + weight][us]++;
     }
 
     return score;
 }
 
-template<Color us>
+template <bool trace, Color us>
 static inline int evaluate_control(EvalData& data)
 {
+    if constexpr (trace)
+        data.trace->coeffs[Trace::MiscEval_control][us] += data.attackers_count[us] - data.attackers_count[!us];
+
     return MiscEval::control * (data.attackers_count[us] - data.attackers_count[!us]);    
 }
 
-static inline int scale_score(Position const &position, int score)
+// Material and piece square coefficients, the
+// score itself is kept incrementally by Position
+static void trace_psqt(Position const &position, EvalTrace &trace)
+{
+    constexpr Trace::Term value_term[total_pieces - 1]{
+        Trace::PawnEval_value, Trace::KnightEval_value, Trace::BishopEval_value, Trace::RookEval_value, Trace::QueenEval_value};
+
+    constexpr Trace::Term psqt_term[total_pieces]{
+        Trace::PawnEval_psqt, Trace::KnightEval_psqt, Trace::BishopEval_psqt, Trace::RookEval_psqt, Trace::QueenEval_psqt, Trace::KingEval_psqt};
+
+    for (uint64_t pieces = position.total_occupancy(); pieces;)
+    {
+        Square sq = pop_lsb(pieces);
+        Piece piece = position.pieces.squares[sq];
+        PieceType type = type_of(piece);
+        Color color = color_of(piece);
+
+        if (type != King)
+            trace.coeffs[value_term[type]][color]++;
+        trace.coeffs[psqt_term[type] + psqt_sq(sq, color)][color]++;
+    }
+}
+
+static inline int scale_score(Position const &position, MaterialEntry const &material, int score, EvalTrace *trace = nullptr)
 {
 #define mg_score(s) ((int16_t)((uint16_t)((unsigned)((s)))))
 #define eg_score(s) ((int16_t)((uint16_t)((unsigned)((s) + 0x8000) >> 16)))
-    int phase = get_phase(position);
-    return ((mg_score(score) * (256 - phase)) + (eg_score(score) * phase)) / 256;
+    int eg = eg_score(score);
+    int scale = material.scale[eg > 0 ? White : Black];
+
+    if (material.single_bishops)
+    {
+        bool white_dark = position.pieces.get_piece_bb<Bishop>(White) & BitMask::dark_squares;
+        bool black_dark = position.pieces.get_piece_bb<Bishop>(Black) & BitMask::dark_squares;
+
+        if (white_dark != black_dark)
+            scale = std::min(scale, Material::full_scale / 2);
+    }
+
+    if (trace)
+    {
+        trace->scale = scale;
+        trace->phase = material.phase;
+    }
+
+    eg = eg * scale / Material::full_scale;
+    return ((mg_score(score) * (256 - material.phase)) + (eg * material.phase)) / 256;
 }
 
-int eval_position(Position const &position)
+template <bool trace>
+static int evaluate(Position const &position, EvalTrace *tracer = nullptr)
 {
     int score = 0;
+    MaterialEntry const &material = Material::probe(position);
+
+    if constexpr (trace)
+        tracer->linear = !material.draw && !material.endgame;
 
-    if (material_draw(position))
+    if (material.draw)
         return 0;
 
+    if (material.endgame)
+    {
+        score = material.endgame(position, material.strong);
+        return position.side == material.strong ? score : -score;
+    }
+
+    if (!trace && NNUE::enabled())
+        return NNUE::evaluate(position);
+
+#ifndef NDEBUG
+    if (position.psqt_score != PSQT::evaluate(position.pieces))
+    {
+        std::cerr << "incremental psqt score is out of sync\n" << position << std::endl;
+        std::abort();
+    }
+#endif
+
     EvalData data;
     data.init(position);
+    data.trace = tracer;
+
+    if constexpr (trace)
+        trace_psqt(position, *tracer);
 
-    score += evaluate_piece<Pawn>(position, data, evaluate_pawn);
-    score += evaluate_piece<Knight>(position, data, evaluate_knight);
-    score += evaluate_piece<Rook>(position, data, evaluate_rook);
-    score += evaluate_piece<Bishop>(position, data, evaluate_bishop);
-    score += evaluate_piece<Queen>(position, data, evaluate_queen);
+    score += position.psqt_score;
 
-    score += eval_king(position, data, White);
-    score -= eval_king(position, data, Black);
+    score += evaluate_pawns<trace>(position, data);
+    score += evaluate_piece<Knight>(position, data, evaluate_knight<trace>);
+    score += evaluate_piece<Rook>(position, data, evaluate_rook<trace>);
+    score += evaluate_piece<Bishop>(position, data, evaluate_bishop<trace>);
+    score += evaluate_piece<Queen>(position, data, evaluate_queen<trace>);
 
-    score += evaluate_control<White>(data);
-    score -= evaluate_control<Black>(data);
+    score += eval_king<trace>(position, data, White);
+    score -= eval_king<trace>(position, data, Black);
 
-    score = scale_score(position, score);
+    score += evaluate_control<trace, White>(data);
+    score -= evaluate_control<trace, Black>(data);
 
+    score = scale_score(position, material, score, tracer);
+
+    return position.side == White ? score : -score;
+}
+
+int eval_position(Position const &position)
+{
+    int score = 0;
+    uint64_t key = position.key.data();
+    EvalTables &tables = eval_tables();
+
+    tables.stats.eval_probes++;
+    if (tables.evals.probe(key, score))
+    {
+        tables.stats.eval_hits++;
+        return score;
+    }
+
+    score = evaluate<false>(position);
+    tables.evals.store(key, score);
+    return score;
+}
+
+int eval_position(Position const &position, int alpha, int beta)
+{
+    int score = 0;
+    uint64_t key = position.key.data();
+    EvalTables &tables = eval_tables();
+
+    tables.stats.eval_probes++;
+    if (tables.evals.probe(key, score))
+    {
+        tables.stats.eval_hits++;
+        return score;
+    }
+
+    MaterialEntry const &material = Material::probe(position);
+
+    // Material, piece square and pawn structure scores are nearly free,
+    // when they are far outside the window the rest won't bring them back
+    if (!material.draw && !material.endgame && !NNUE::enabled())
+    {
+        int cheap = position.psqt_score + probe_pawn_table(position).score;
+        cheap = scale_score(position, material, cheap);
+        cheap = position.side == White ? cheap : -cheap;
+
+        if (cheap - lazy_margin >= beta || cheap + lazy_margin <= alpha)
+        {
+            tables.stats.lazy_exits++;
+            return cheap;
+        }
+    }
+
+    score = evaluate<false>(position);
+    tables.evals.store(key, score);
+    return score;
+}
+
+int trace_position(Position const &position, EvalTrace &trace)
+{
+    std::memset(&trace, 0, sizeof(EvalTrace));
+
+    int score = evaluate<true>(position, &trace);
     return position.side == White ? score : -score;
 }
+
+// Mg/eg contribution of every term for both sides, the phase scaling and
+// the final score, then the coefficient vector as the tuner reads it
+void print_eval_trace(Position const &position)
+{
+    EvalTrace trace;
+    int score = trace_position(position, trace);
+
+    auto row = [](std::string const &name, int const *values) {
+        std::cout << std::setw(28) << std::left << name << std::right;
+        for (int i = 0; i < 6; i++)
+            std::cout << std::setw(i % 2 ? 6 : 8) << values[i];
+        std::cout << '\n';
+    };
+
+    std::cout << std::setw(28) << std::left << "Term" << std::right
+              << std::setw(8) << "White" << std::setw(6) << ""
+              << std::setw(8) << "Black" << std::setw(6) << ""
+              << std::setw(8) << "Total" << "\n";
+    std::cout << std::setw(28) << "" << "      mg    eg      mg    eg      mg    eg\n";
+
+    int total[6] = {0};
+
+#define X(space, name)                                                      \
+    {                                                                       \
+        int sums[6] = {0};                                                  \
+        for (int i = 0; i < Trace::term_size(space::name); i++)             \
+        {                                                                   \
+            int value = Trace::term_values(space::name)[i];                 \
+            for (Color color : {White, Black})                              \
+            {                                                               \
+                int coeff = trace.coeffs[Trace::space##_##name + i][color]; \
+                sums[color * 2] += coeff * mg_score(value);                 \
+                sums[color * 2 + 1] += coeff * eg_score(value);             \
+            }                                                               \
+        }                                                                   \
+        sums[4] = sums[0] - sums[2];                                        \
+        sums[5] = sums[1] - sums[3];                                        \
+        for (int i = 0; i < 6; i++)                                         \
+            total[i] += sums[i];                                            \
+        if (sums[0] || sums[1] || sums[2] || sums[3])                       \
+            row(#space "::" #name, sums);                                   \
+    }
+    EVAL_TERMS(X)
+#undef X
+
+    row("Total", total);
+
+    std::cout << "\nphase " << trace.phase << "/256, eg scale " << trace.scale << "/" << Material::full_scale
+              << ", eg after scaling " << total[5] * trace.scale / Material::full_scale << "\n";
+
+    if (!trace.linear)
+        std::cout << "score given by a draw rule or an endgame evaluator, not the terms above\n";
+
+    std::cout << "classical eval " << score << " (white)\n";
+
+    if (NNUE::enabled())
+    {
+        int nnue = NNUE::evaluate(position);
+        std::cout << "nnue eval " << (position.side == White ? nnue : -nnue) << " (white)\n";
+    }
+
+    std::cout << "coefficients phase " << trace.phase << " scale " << trace.scale;
+    for (int i = 0; i < Trace::total_terms; i++)
+    {
+        int coeff = trace.coeffs[i][White] - trace.coeffs[i][Black];
+        if (coeff)
+            std::cout << ' ' << i << ':' << coeff;
+    }
+    std::cout << std::endl;
+}
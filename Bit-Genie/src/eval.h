@@ -17,5 +17,56 @@
 */
 #pragma once
 #include "misc.h"
+#include "evalcache.h"
+#include "material.h"
+#include "pawntable.h"
 
-int eval_position(Position const &);
\ No newline at end of file
+int eval_position(Position const &);
+
+// Lazy evaluation, returns a cheap estimate instead when it lies
+// more than the lazy margin outside [alpha, beta]
+int eval_position(Position const &, int alpha, int beta);
+
+void set_lazy_margin(int);
+
+// Probes made with one thread's evaluation caches
+struct EvalCacheStats
+{
+    uint64_t pawn_probes = 0;
+    uint64_t pawn_hits = 0;
+    uint64_t material_probes = 0;
+    uint64_t material_hits = 0;
+    uint64_t eval_probes = 0;
+    uint64_t eval_hits = 0;
+    uint64_t lazy_exits = 0;
+};
+
+// The caches one search thread evaluates with. SearchInit owns them and
+// they outlive the threads, so each search starts with warm tables
+struct EvalTables
+{
+    PawnTable pawns;
+    MaterialTable materials;
+    EvalCache evals;
+    EvalCacheStats stats;
+};
+
+// Evaluate with the given tables on the calling thread. Threads that never
+// bind any (the uci thread for bench, tuner workers) get a private set
+void bind_eval_tables(EvalTables &);
+EvalTables &eval_tables();
+
+EvalCacheStats &eval_cache_stats();
+
+// Forget the calling thread's cached evaluations, needed
+// when the evaluation itself changes
+void clear_eval_cache();
+
+struct EvalTrace;
+
+// Hand crafted evaluation without caches or the network, recording the
+// coefficient of every term in evalscores.h. Score is from white's view
+int trace_position(Position const &, EvalTrace &);
+
+// The traced evaluation broken down per term, for the "eval" command
+void print_eval_trace(Position const &);
@@ -0,0 +1,52 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "misc.h"
+#include <cstring>
+
+// Static evaluations of recently seen positions. Every entry is a single
+// word holding the upper 48 bits of the key and the score, and each
+// search thread has its own table, so no locking is needed
+class EvalCache
+{
+public:
+    static constexpr int size = 1 << 16;
+
+    bool probe(uint64_t key, int &score) const
+    {
+        uint64_t entry = entries[key & (size - 1)];
+        if ((entry ^ key) >> 16)
+            return false;
+
+        score = int16_t(entry & 0xFFFF);
+        return true;
+    }
+
+    void store(uint64_t key, int score)
+    {
+        entries[key & (size - 1)] = (key & ~0xFFFFull) | uint16_t(score);
+    }
+
+    void clear()
+    {
+        std::memset(entries, 0, sizeof(entries));
+    }
+
+private:
+    uint64_t entries[size] = {0};
+};
@@ -0,0 +1,93 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "misc.h"
+#include "evalscores.h"
+#include <type_traits>
+
+// Every tunable S(mg, eg) term of evalscores.h in file order as
+// (namespace, name). Anything walking the parameters uses this list
+#define EVAL_TERMS(X)               \
+    X(PawnEval, stacked)            \
+    X(PawnEval, isolated)           \
+    X(PawnEval, passed_connected)   \
+    X(PawnEval, value)              \
+    X(PawnEval, psqt)               \
+    X(PawnEval, passed)             \
+    X(PawnEval, passer_blocked)     \
+    X(KnightEval, value)            \
+    X(KnightEval, psqt)             \
+    X(KnightEval, mobility)         \
+    X(BishopEval, value)            \
+    X(BishopEval, psqt)             \
+    X(BishopEval, mobility)         \
+    X(RookEval, value)              \
+    X(RookEval, psqt)               \
+    X(RookEval, mobility)           \
+    X(RookEval, open_file)          \
+    X(RookEval, semi_open_file)     \
+    X(QueenEval, value)             \
+    X(QueenEval, psqt)              \
+    X(QueenEval, mobility)          \
+    X(KingEval, psqt)               \
+    X(KingEval, safety_table)       \
+    X(MiscEval, control)
+
+namespace Trace
+{
+    template <typename T>
+    constexpr int term_size(T const &)
+    {
+        if constexpr (std::is_array_v<T>)
+            return std::extent_v<T>;
+        else
+            return 1;
+    }
+
+    template <typename T>
+    constexpr int const *term_values(T const &term)
+    {
+        if constexpr (std::is_array_v<T>)
+            return term;
+        else
+            return &term;
+    }
+
+    // Index of the first parameter of every term in the flat coefficient vector
+    enum Term : int
+    {
+#define X(space, name) space##_##name, space##_##name##_last = space##_##name + term_size(space::name) - 1,
+        EVAL_TERMS(X)
+#undef X
+        total_terms
+    };
+}
+
+// How many times each parameter was counted for either side. The static
+// evaluation is linear in the parameters, with the phase and scale taken
+// from the position, so these are its coefficients
+struct EvalTrace
+{
+    int coeffs[Trace::total_terms][total_colors];
+    int phase;
+    int scale;
+
+    // False when a draw rule or an endgame evaluator
+    // gave the score rather than the terms above
+    bool linear;
+};
@@ -19,11 +19,15 @@
 #include "uci.h"
 #include "zobrist.h"
 #include "search.h"
+#include "bitbase.h"
+#include "material.h"
 
 int main(int argc, char **argv)
 {
     Attacks::init();
     ZobristKey::init();
     init_lmr_array();
+    KPK::init();
+    Material::init();
     uci_input_loop(argc, argv);
 }
\ No newline at end of file
@@ -0,0 +1,241 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "material.h"
+#include "bitbase.h"
+#include "bitboard.h"
+#include "eval.h"
+#include "position.h"
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    constexpr int known_win = 1000;
+
+    struct Endgame
+    {
+        uint64_t key;
+        EndgameFunction evaluate;
+        Color strong;
+    };
+
+    std::vector<Endgame> endgames;
+
+    int distance(Square a, Square b)
+    {
+        return std::max(std::abs((a & 7) - (b & 7)), std::abs((a >> 3) - (b >> 3)));
+    }
+
+    // Bigger the closer a square is to the edge of the board
+    int push_to_edge(Square sq)
+    {
+        int file = sq & 7, rank = sq >> 3;
+        return 20 * (6 - std::min(file, 7 - file) - std::min(rank, 7 - rank));
+    }
+
+    int push_close(Square a, Square b)
+    {
+        return 10 * (7 - distance(a, b));
+    }
+
+    Square king_square(Position const &position, Color color)
+    {
+        return get_lsb(position.pieces.get_piece_bb<King>(color));
+    }
+
+    // KQK and KRK, drive the king to the edge and bring ours along
+    int evaluate_kxk(Position const &position, Color strong)
+    {
+        Square strong_king = king_square(position, strong);
+        Square weak_king = king_square(position, !strong);
+
+        return known_win + push_to_edge(weak_king) + push_close(strong_king, weak_king);
+    }
+
+    // The king can only be mated in a corner the bishop controls
+    int evaluate_kbnk(Position const &position, Color strong)
+    {
+        Square strong_king = king_square(position, strong);
+        Square weak_king = king_square(position, !strong);
+        bool dark = position.pieces.get_piece_bb<Bishop>(strong) & BitMask::dark_squares;
+
+        // Manhattan distance to the nearest such corner, it keeps improving
+        // as the king is pushed along the edge where distance() doesn't
+        int file = weak_king & 7, rank = weak_king >> 3;
+        int corner = dark ? std::min(file + rank, 14 - file - rank) : std::min(7 - file + rank, 7 + file - rank);
+
+        return known_win + 20 * (14 - corner) + push_close(strong_king, weak_king);
+    }
+
+    int evaluate_kpk(Position const &position, Color strong)
+    {
+        // The bitbase is from white's point of view
+        int flip = strong == White ? 0 : 56;
+        Square strong_king = to_sq(king_square(position, strong) ^ flip);
+        Square weak_king = to_sq(king_square(position, !strong) ^ flip);
+        Square pawn = to_sq(get_lsb(position.pieces.bitboards[Pawn]) ^ flip);
+        Color side = strong == White ? position.side : !position.side;
+
+        if (!KPK::is_win(strong_king, pawn, weak_king, side))
+            return 0;
+
+        // Less than any won pawnless ending so that promoting is always better
+        return known_win / 2 + 20 * (pawn >> 3);
+    }
+
+    // Signatures are written as the strong side's pieces followed by the
+    // weak side's, e.g. "KBNK". Every endgame is added for both colors
+    void add_endgame(std::string_view code, EndgameFunction evaluate)
+    {
+        for (Color strong : {White, Black})
+        {
+            uint64_t key = 0;
+            Color owner = !strong;
+
+            for (char c : code)
+            {
+                PieceType type = c == 'P' ? Pawn : c == 'N' ? Knight : c == 'B' ? Bishop : c == 'R' ? Rook : c == 'Q' ? Queen : King;
+                if (type == King)
+                    owner = !owner;
+
+                key += Material::piece_key(make_piece(type, owner));
+            }
+            endgames.push_back({key, evaluate, strong});
+        }
+    }
+
+    bool material_draw(int const (&counts)[total_colors * total_pieces])
+    {
+        auto count = [&](PieceType type, Color color)
+        { return counts[make_piece(type, color)]; };
+
+        auto total = [&](PieceType type)
+        { return count(type, White) + count(type, Black); };
+
+        if (total(Pawn) || total(Queen))
+            return false;
+
+        if (!total(Rook))
+        {
+            if (!total(Bishop))
+                return count(Knight, Black) <= 2 && count(Knight, White) <= 2;
+
+            if (!total(Knight))
+                return std::abs(count(Bishop, White) - count(Bishop, Black)) <= 2;
+        }
+
+        // Rook vs 2 minors
+        else if (total(Rook) == 1)
+        {
+            Color owner = count(Rook, White) ? White : Black;
+            int minors = count(Bishop, !owner) + count(Knight, !owner);
+
+            return !(count(Bishop, owner) + count(Knight, owner)) && (minors == 1 || minors == 2);
+        }
+
+        return false;
+    }
+
+    MaterialEntry compute(uint64_t key)
+    {
+        MaterialEntry entry;
+        entry.key = key;
+
+        int counts[total_colors * total_pieces];
+        for (int piece = 0; piece < total_colors * total_pieces; piece++)
+            counts[piece] = Material::count(key, Piece(piece));
+
+        auto count = [&](PieceType type, Color color)
+        { return counts[make_piece(type, color)]; };
+
+        int knights = count(Knight, White) + count(Knight, Black);
+        int bishops = count(Bishop, White) + count(Bishop, Black);
+        int rooks = count(Rook, White) + count(Rook, Black);
+        int queens = count(Queen, White) + count(Queen, Black);
+
+        int phase = 19 - knights - bishops - 2 * rooks - 4 * queens;
+        entry.phase = (phase * 256 + 12) / 24;
+        entry.draw = material_draw(counts);
+
+        for (auto const &endgame : endgames)
+        {
+            if (endgame.key == key)
+            {
+                entry.endgame = endgame.evaluate;
+                entry.strong = endgame.strong;
+            }
+        }
+
+        // Without pawns, being up less than a rook is hard to win
+        for (Color us : {White, Black})
+        {
+            int ours = 3 * (count(Knight, us) + count(Bishop, us)) + 5 * count(Rook, us) + 9 * count(Queen, us);
+            int theirs = 3 * (count(Knight, !us) + count(Bishop, !us)) + 5 * count(Rook, !us) + 9 * count(Queen, !us);
+
+            entry.scale[us] = Material::full_scale;
+            if (!count(Pawn, us) && ours - theirs <= 3)
+                entry.scale[us] = ours < 5 ? 0 : theirs <= 3 ? 4 : 14;
+        }
+
+        entry.single_bishops = count(Bishop, White) == 1 && count(Bishop, Black) == 1 
+                            && !knights && !rooks && !queens;
+        return entry;
+    }
+}
+
+namespace Material
+{
+    uint64_t generate_key(PieceManager const &pieces)
+    {
+        uint64_t key = 0;
+        for (Piece piece : pieces.squares)
+        {
+            if (piece != Empty)
+                key += piece_key(piece);
+        }
+        return key;
+    }
+
+    void init()
+    {
+        endgames.clear();
+
+        add_endgame("KQK", evaluate_kxk);
+        add_endgame("KRK", evaluate_kxk);
+        add_endgame("KBNK", evaluate_kbnk);
+        add_endgame("KPK", evaluate_kpk);
+    }
+
+    MaterialEntry const &probe(Position const &position)
+    {
+        EvalTables &tables = eval_tables();
+        EvalCacheStats &stats = tables.stats;
+        MaterialEntry &entry = tables.materials.probe(position.material_key);
+
+        stats.material_probes++;
+        if (entry.key == position.material_key)
+        {
+            stats.material_hits++;
+            return entry;
+        }
+
+        entry = compute(position.material_key);
+        return entry;
+    }
+}
@@ -0,0 +1,84 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "misc.h"
+#include "piece.h"
+
+// Evaluation of a specialised endgame, from the strong side's point of view
+using EndgameFunction = int (*)(Position const &, Color strong);
+
+// Everything the evaluation knows about a combination of material. It
+// only depends on the piece counts, so it is cached per search thread
+// under the material key
+struct MaterialEntry
+{
+    uint64_t key = 0;
+    EndgameFunction endgame = nullptr;
+    int phase = 0;
+
+    // Endgame score multiplier out of Material::full_scale,
+    // used for the side the score favours
+    uint8_t scale[total_colors] = {0};
+
+    Color strong = White;
+    bool draw = false;
+
+    // Only pawns and one bishop each, scaled down
+    // further if the bishops are on opposite colors
+    bool single_bishops = false;
+};
+
+// Material entries indexed by the material key
+class MaterialTable
+{
+public:
+    static constexpr int size = 1 << 13;
+
+    MaterialEntry &probe(uint64_t key)
+    {
+        // Piece counts are far from random, mix them before indexing
+        return entries[(key * 0x9E3779B97F4A7C15ull) >> 51];
+    }
+
+private:
+    MaterialEntry entries[size];
+};
+
+namespace Material
+{
+    constexpr int full_scale = 64;
+
+    // The material key packs the count of every piece into four
+    // bits, so moves can update it by adding and subtracting
+    inline uint64_t piece_key(Piece piece)
+    {
+        return 1ull << (4 * piece);
+    }
+
+    inline int count(uint64_t key, Piece piece)
+    {
+        return (key >> (4 * piece)) & 15;
+    }
+
+    uint64_t generate_key(PieceManager const &);
+
+    // Register the specialised endgames
+    void init();
+
+    MaterialEntry const &probe(Position const &);
+}
@@ -52,6 +52,7 @@ class SHistory;
 class TTable;
 class ZobristKey;
 
+struct EvalTables;
 struct SearchInfo;
 struct SearchLimits;
 struct Search;
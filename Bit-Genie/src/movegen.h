@@ -35,31 +35,78 @@ public:
     template <MoveGenType type = MoveGenType::normal>
     void generate(Position &position)
     {
-        uint64_t targets = get_targets<type>(position);
+        if (position.side == White)
+            generate<type, White>(position);
+        else
+            generate<type, Black>(position);
+    }
+
+    void generate_castle(Position &position)
+    {
+        if (position.side == White)
+            generate_castle<White>(position);
+        else
+            generate_castle<Black>(position);
+    }
+
+public:
+    Movelist movelist;
+
+private:
+    // Squares a non-king move has to land on (everything, the
+    // checking piece and the squares in between, or nothing in
+    // double check) and our pieces pinned to the king
+    uint64_t checkmask = ~0ull;
+    uint64_t checkers = 0;
+    uint64_t pinned = 0;
+    Square king_sq;
+
+    // The side to move is a template parameter from here on, so
+    // pawn directions, ranks and attack tables are constants
+    template <MoveGenType type, Color us>
+    void generate(Position &position)
+    {
+        uint64_t targets = get_targets<type, us>(position);
         uint64_t occupancy = position.total_occupancy();
 
-        generate_normal_moves(position, King, targets, Attacks::king);
-        generate_normal_moves(position, Knight, targets, Attacks::knight);
-        generate_normal_moves(position, Bishop, targets, Attacks::bishop, occupancy);
-        generate_normal_moves(position, Rook, targets, Attacks::rook, occupancy);
-        generate_normal_moves(position, Queen, targets, Attacks::queen, occupancy);
-        generate_pawn_moves<type>(position);
+        if constexpr (checked)
+            find_checks_and_pins<us>(position);
+
+        generate_normal_moves<King, us>(position, targets, Attacks::king);
+
+        // Only the king can get out of a double check
+        if (checkmask)
+        {
+            generate_normal_moves<Knight, us>(position, targets & checkmask, Attacks::knight);
+            generate_normal_moves<Bishop, us>(position, targets & checkmask, Attacks::bishop, occupancy);
+            generate_normal_moves<Rook, us>(position, targets & checkmask, Attacks::rook, occupancy);
+            generate_normal_moves<Queen, us>(position, targets & checkmask, Attacks::queen, occupancy);
+            generate_pawn_moves<type, us>(position);
+        }
 
         if constexpr (type == MoveGenType::quiet || type == MoveGenType::normal)
         {
-            uint64_t king = position.pieces.get_piece_bb<King>(position.side);
-            if (!Attacks::square_attacked(position, get_lsb(king), !position.side, occupancy))
-                generate_castle(position);
+            if constexpr (checked)
+            {
+                if (!checkers)
+                    generate_castle<us>(position);
+            }
+            else
+            {
+                uint64_t king = position.pieces.get_piece_bb<King>(us);
+                if (!Attacks::square_attacked(position, get_lsb(king), !us, occupancy))
+                    generate_castle<us>(position);
+            }
         }
     }
 
+    template <Color us>
     void generate_castle(Position &position)
     {
+        constexpr Square king_from = us == White ? Square::E1 : Square::E8;
         uint64_t occupancy = position.total_occupancy();
-        bool is_white = position.side == White;
-        Square king_sq = is_white ? Square::E1 : Square::E8;
 
-        uint64_t rooks = position.castle_rights.get_rooks(position.side);
+        uint64_t rooks = position.castle_rights.get_rooks(us);
         while (rooks)
         {
             Square rook = pop_lsb(rooks);
@@ -67,25 +114,60 @@ public:
             if (!(CastleRights::castle_path_is_clear(rook, occupancy)))
                 continue;
 
-            if (castle_path_is_attacked(position, rook, !position.side))
+            if (castle_path_is_attacked(position, rook, !us))
                 continue;
 
-            movelist.add<checked>(position, CreateMove(king_sq, rook, MoveFlag::castle, 1));
+            movelist.add<us, checked>(position, CreateMove(king_from, rook, MoveFlag::castle, 1));
         }
     }
 
-public:
-    Movelist movelist;
+    template <Color us>
+    void find_checks_and_pins(Position const &position)
+    {
+        uint64_t enemy = position.pieces.get_occupancy(!us);
+        uint64_t occupancy = position.total_occupancy();
+        uint64_t queens = position.pieces.bitboards[Queen];
+        uint64_t bishops = (position.pieces.bitboards[Bishop] | queens) & enemy;
+        uint64_t rooks = (position.pieces.bitboards[Rook] | queens) & enemy;
 
-private:
-    template <MoveGenType type>
+        king_sq = get_lsb(position.pieces.get_piece_bb<King>(us));
+        pinned = 0;
+
+        checkers = (BitMask::pawn_attacks[us][king_sq] & position.pieces.bitboards[Pawn] & enemy) |
+                   (Attacks::knight(king_sq) & position.pieces.bitboards[Knight] & enemy);
+
+        // Sliders that see the king through nothing but our own pieces
+        uint64_t snipers = (Attacks::bishop(king_sq, enemy) & bishops) | (Attacks::rook(king_sq, enemy) & rooks);
+
+        while (snipers)
+        {
+            Square sniper = pop_lsb(snipers);
+            uint64_t blockers = BitMask::between(king_sq, sniper) & occupancy;
+
+            if (!blockers)
+                checkers |= 1ull << sniper;
+            else if (!(blockers & (blockers - 1)))
+                pinned |= blockers;
+        }
+
+        if (!checkers)
+            checkmask = ~0ull;
+        else if (!(checkers & (checkers - 1)))
+            checkmask = BitMask::between(king_sq, get_lsb(checkers)) | checkers;
+        else
+            checkmask = 0;
+    }
+
+    template <MoveGenType type, Color us>
     uint64_t get_targets(Position const &position)
     {
-        return type == MoveGenType::normal ? ~position.friend_bb() : type == MoveGenType::noisy ? position.enemy_bb()
-                                                                                                : ~position.total_occupancy();
+        return type == MoveGenType::normal ? ~position.pieces.get_occupancy(us) : type == MoveGenType::noisy ? position.pieces.get_occupancy(!us)
+                                                                                                              : ~position.total_occupancy();
     }
 
-    template <bool is_promo = false>
+    // The check and pin masks already make every move legal
+    // except for king moves, castling and en passant captures
+    template <Color us, bool is_promo = false, bool verify = false>
     void add_moves(Position &pos, Square from, uint64_t attacks, MoveFlag gen_type)
     {
         assert(is_ok(from));
@@ -94,80 +176,107 @@ private:
             Square to = pop_lsb(attacks);
             if constexpr (is_promo)
             {
-                movelist.add<checked>(pos, CreateMove(from, to, gen_type, Knight));
-                movelist.add<checked>(pos, CreateMove(from, to, gen_type, Bishop));
-                movelist.add<checked>(pos, CreateMove(from, to, gen_type, Rook));
-                movelist.add<checked>(pos, CreateMove(from, to, gen_type, Queen));
+                movelist.add<us, verify>(pos, CreateMove(from, to, gen_type, Knight));
+                movelist.add<us, verify>(pos, CreateMove(from, to, gen_type, Bishop));
+                movelist.add<us, verify>(pos, CreateMove(from, to, gen_type, Rook));
+                movelist.add<us, verify>(pos, CreateMove(from, to, gen_type, Queen));
             }
-            movelist.add<checked>(pos, CreateMove(from, to, gen_type, Knight));
+            movelist.add<us, verify>(pos, CreateMove(from, to, gen_type, Knight));
         }
     }
 
-    template <typename Callable, typename... Args>
-    void generate_normal_moves(Position &position, PieceType p_type, uint64_t targets, Callable F, Args const &...args)
+    template <PieceType p_type, Color us, typename Callable, typename... Args>
+    void generate_normal_moves(Position &position, uint64_t targets, Callable F, Args const &...args)
     {
-        uint64_t pieces = position.pieces.get_piece_bb(make_piece(p_type, position.side));
+        uint64_t pieces = position.pieces.get_piece_bb<p_type>(us);
         while (pieces)
         {
             Square sq = pop_lsb(pieces);
             uint64_t attacks = F(sq, args...) & targets;
-            add_moves(position, sq, attacks, MoveFlag::normal);
+
+            if constexpr (p_type == King)
+            {
+                add_moves<us, false, checked>(position, sq, attacks, MoveFlag::normal);
+                continue;
+            }
+
+            if (pinned & (1ull << sq))
+                attacks &= BitMask::line(king_sq, sq);
+
+            add_moves<us>(position, sq, attacks, MoveFlag::normal);
         }
     }
 
-    template <bool is_promo = false>
-    inline void add_pawn_moves(Position &pos, uint64_t attacks, Direction delta, MoveFlag gen_type = MoveFlag::normal)
+    template <Color us, Direction delta, bool is_promo = false, bool verify = false>
+    inline void add_pawn_moves(Position &pos, uint64_t attacks, MoveFlag gen_type = MoveFlag::normal)
     {
         while (attacks)
         {
             Square sq = pop_lsb(attacks);
             if constexpr (is_promo)
             {
-                movelist.add<checked>(pos, CreateMove(sq - delta, sq, gen_type, Knight));
-                movelist.add<checked>(pos, CreateMove(sq - delta, sq, gen_type, Bishop));
-                movelist.add<checked>(pos, CreateMove(sq - delta, sq, gen_type, Rook));
-                movelist.add<checked>(pos, CreateMove(sq - delta, sq, gen_type, Queen));
+                movelist.add<us, verify>(pos, CreateMove(sq - delta, sq, gen_type, Knight));
+                movelist.add<us, verify>(pos, CreateMove(sq - delta, sq, gen_type, Bishop));
+                movelist.add<us, verify>(pos, CreateMove(sq - delta, sq, gen_type, Rook));
+                movelist.add<us, verify>(pos, CreateMove(sq - delta, sq, gen_type, Queen));
             }
             else
             {
-                movelist.add<checked>(pos, CreateMove(sq - delta, sq, gen_type, Knight));
+                movelist.add<us, verify>(pos, CreateMove(sq - delta, sq, gen_type, Knight));
             }
         }
     }
 
-    template <MoveGenType type>
+    // Pinned pawns are generated one at a time,
+    // each restricted to the line it is pinned on
+    template <MoveGenType type, Color us>
     void generate_pawn_moves(Position &position)
     {
-        uint64_t pawn_st_rank = position.side == White ? BitMask::rank4 : BitMask::rank5;
-        uint64_t promotion_rank = position.side == White ? BitMask::rank7 : BitMask::rank2;
-        uint64_t ep_rank = position.side == White ? BitMask::rank6 : BitMask::rank3;
+        uint64_t pawns = position.pieces.get_piece_bb<Pawn>(us);
 
-        Direction forward = position.side == White ? Direction::north : Direction::south;
-        uint64_t empty = ~position.total_occupancy();
-        uint64_t enemy = position.enemy_bb();
+        generate_pawn_moves<type, us>(position, pawns & ~pinned, checkmask);
+
+        for (uint64_t pins = pawns & pinned; pins;)
+        {
+            Square sq = pop_lsb(pins);
+            generate_pawn_moves<type, us>(position, 1ull << sq, checkmask & BitMask::line(king_sq, sq));
+        }
+    }
+
+    template <MoveGenType type, Color us>
+    void generate_pawn_moves(Position &position, uint64_t pawns, uint64_t destinations)
+    {
+        constexpr uint64_t pawn_st_rank = us == White ? BitMask::rank4 : BitMask::rank5;
+        constexpr uint64_t promotion_rank = us == White ? BitMask::rank7 : BitMask::rank2;
+        constexpr uint64_t ep_rank = us == White ? BitMask::rank6 : BitMask::rank3;
+
+        constexpr Direction forward = us == White ? Direction::north : Direction::south;
+        constexpr Direction left_capture = forward + Direction::west;
+        constexpr Direction right_capture = forward + Direction::east;
 
-        uint64_t pawns = position.pieces.get_piece_bb(make_piece(Pawn, position.side));
+        uint64_t empty = ~position.total_occupancy();
+        uint64_t enemy = position.pieces.get_occupancy(!us);
 
         uint64_t pawns_normal = pawns & ~promotion_rank;
         uint64_t pawns_promo = pawns & promotion_rank;
 
         if constexpr (type == MoveGenType::normal || type == MoveGenType::quiet)
         {
-            uint64_t push_one_normal = shift(pawns_normal, forward) & empty;
-            uint64_t push_two_noraml = shift(push_one_normal, forward) & empty & pawn_st_rank;
+            uint64_t push_one_normal = shift<forward>(pawns_normal) & empty;
+            uint64_t push_two_noraml = shift<forward>(push_one_normal) & empty & pawn_st_rank;
 
-            add_pawn_moves(position, push_one_normal, forward);
-            add_pawn_moves(position, push_two_noraml, forward + forward);
+            add_pawn_moves<us, forward>(position, push_one_normal & destinations);
+            add_pawn_moves<us, forward + forward>(position, push_two_noraml & destinations);
 
-            push_one_normal = shift(pawns_promo, forward) & empty;
-            add_pawn_moves<true>(position, push_one_normal, forward, MoveFlag::promotion);
+            push_one_normal = shift<forward>(pawns_promo) & empty & destinations;
+            add_pawn_moves<us, forward, true>(position, push_one_normal, MoveFlag::promotion);
         }
 
         if constexpr (type == MoveGenType::normal || type == MoveGenType::noisy)
         {
-            uint64_t forward_one = shift(pawns_normal, forward);
-            uint64_t left = shift<Direction::west>(forward_one) & enemy;
-            uint64_t right = shift<Direction::east>(forward_one) & enemy;
+            uint64_t forward_one = shift<forward>(pawns_normal);
+            uint64_t left = shift<Direction::west>(forward_one) & enemy & destinations;
+            uint64_t right = shift<Direction::east>(forward_one) & enemy & destinations;
 
             if (position.ep_sq != Square::bad_sq)
             {
@@ -176,19 +285,21 @@ private:
                 uint64_t left_ep = shift<Direction::west>(forward_one) & ep_bb & ep_rank;
                 uint64_t right_ep = shift<Direction::east>(forward_one) & ep_bb & ep_rank;
 
-                add_pawn_moves(position, left_ep, forward + Direction::west, MoveFlag::enpassant);
-                add_pawn_moves(position, right_ep, forward + Direction::east, MoveFlag::enpassant);
+                // The captured pawn may be the checker and both pawns leave the
+                // rank, the masks can't tell whether these are legal
+                add_pawn_moves<us, left_capture, false, checked>(position, left_ep, MoveFlag::enpassant);
+                add_pawn_moves<us, right_capture, false, checked>(position, right_ep, MoveFlag::enpassant);
             }
 
-            add_pawn_moves(position, left, forward + Direction::west);
-            add_pawn_moves(position, right, forward + Direction::east);
+            add_pawn_moves<us, left_capture>(position, left);
+            add_pawn_moves<us, right_capture>(position, right);
 
-            forward_one = shift(pawns_promo, forward);
-            left = shift<Direction::west>(forward_one) & enemy;
-            right = shift<Direction::east>(forward_one) & enemy;
+            forward_one = shift<forward>(pawns_promo);
+            left = shift<Direction::west>(forward_one) & enemy & destinations;
+            right = shift<Direction::east>(forward_one) & enemy & destinations;
 
-            add_pawn_moves<true>(position, left, forward + Direction::west, MoveFlag::promotion);
-            add_pawn_moves<true>(position, right, forward + Direction::east, MoveFlag::promotion);
+            add_pawn_moves<us, left_capture, true>(position, left, MoveFlag::promotion);
+            add_pawn_moves<us, right_capture, true>(position, right, MoveFlag::promotion);
         }
     }
 
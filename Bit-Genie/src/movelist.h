@@ -63,12 +63,12 @@ public:
 
     Move &operator[](size_t pos) { return moves[pos]; }
 
-    template <bool check = false>
+    template <Color us, bool check = false>
     void add(Position &position, Move &&move)
     {
         if constexpr (check)
         {
-            if (!position.move_is_legal(move))
+            if (!position.move_is_legal<us>(move))
                 return;
         }
         moves[cap++] = std::move(move);
@@ -88,9 +88,10 @@ static int16_t see(Position &position, Move move)
     return scores[0];
 }
 
-static Move get_hash_move(Position &position, TTable &tt)
+static Move get_hash_move(Position &position, TTable &tt, int ply)
 {
-    return (Move)tt.retrieve(position).move;
+    TEntry entry;
+    return tt.retrieve(position, entry, ply) ? (Move)entry.move : NullMove;
 }
 
 template <bool quiet = false>
@@ -129,13 +130,16 @@ bool MovePicker::next(Move &move)
     if (stage == Stage::HashMove)
     {
         stage = Stage::GenNoisy;
-        Move hash_move = get_hash_move(*position, *table);
+        Move hash_move = get_hash_move(*position, *table, search->info.ply);
 
         if (can_move(hash_move))
         {
             move = hash_move;
             return true;
         }
+
+        if (hash_move != NullMove)
+            search->info.tt_collisions++;
     }
 
     if (stage == Stage::GenNoisy)
@@ -0,0 +1,240 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "nnue.h"
+#include "position.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t file_magic = 0x4E4E4742; // "BGNN"
+    constexpr uint32_t file_version = 1;
+
+    // Activations are clipped to [0, 127] so they fit into int8, the
+    // hidden layers shift their sums back into that range
+    constexpr int activation_max = 127;
+    constexpr int weight_shift = 6;
+    constexpr int output_scale = 16;
+    constexpr int max_score = 16000;
+
+    using namespace NNUE;
+
+    struct Network
+    {
+        alignas(64) int16_t ft_bias[hidden_size];
+        std::vector<int16_t> ft_weights;
+
+        alignas(64) int32_t l1_bias[l1_size];
+        alignas(64) int8_t l1_weights[l1_size][2 * hidden_size];
+
+        alignas(64) int32_t l2_bias[l2_size];
+        alignas(64) int8_t l2_weights[l2_size][l1_size];
+
+        int32_t out_bias;
+        alignas(64) int8_t out_weights[l2_size];
+    };
+
+    std::unique_ptr<Network> network;
+
+    // Index of a piece on a square from the given perspective. Black sees
+    // the board flipped so that both perspectives share the same weights
+    int feature_index(Color perspective, Square king, Piece piece, Square sq)
+    {
+        int orient = perspective == White ? 0 : 56;
+        int piece_index = type_of(piece) * 2 + (color_of(piece) != perspective);
+        return ((king ^ orient) * 10 + piece_index) * total_squares + (sq ^ orient);
+    }
+
+    void add_feature(int16_t *values, int index)
+    {
+        SIMD::kernels.add(values, &network->ft_weights[size_t(index) * hidden_size], hidden_size);
+    }
+
+    void sub_feature(int16_t *values, int index)
+    {
+        SIMD::kernels.sub(values, &network->ft_weights[size_t(index) * hidden_size], hidden_size);
+    }
+
+    void refresh_perspective(Accumulator &accumulator, Position const &position, Color perspective)
+    {
+        int16_t *values = accumulator.values[perspective];
+        std::copy(network->ft_bias, network->ft_bias + hidden_size, values);
+
+        Square king = get_lsb(position.pieces.get_piece_bb<King>(perspective));
+        uint64_t pieces = position.total_occupancy() & ~position.pieces.bitboards[King];
+
+        while (pieces)
+        {
+            Square sq = pop_lsb(pieces);
+            add_feature(values, feature_index(perspective, king, position.pieces.squares[sq], sq));
+        }
+    }
+
+    template <int inputs, int outputs>
+    void forward(uint8_t const *input, int32_t const *bias, int8_t const (*weights)[inputs], uint8_t *output)
+    {
+        int32_t sums[outputs];
+        SIMD::kernels.affine(input, &weights[0][0], bias, sums, inputs, outputs);
+
+        for (int o = 0; o < outputs; o++)
+            output[o] = uint8_t(std::clamp(sums[o] >> weight_shift, 0, activation_max));
+    }
+
+    template <typename T>
+    bool read(std::ifstream &file, T *data, size_t count)
+    {
+        file.read(reinterpret_cast<char *>(data), sizeof(T) * count);
+        return bool(file);
+    }
+}
+
+namespace NNUE
+{
+    void AccumulatorStack::refresh(Position const &position)
+    {
+        index = 0;
+
+        if (!enabled())
+            return;
+
+        refresh_perspective(stack[0], position, White);
+        refresh_perspective(stack[0], position, Black);
+    }
+
+    void AccumulatorStack::push(Position const &position, DirtyPieces const &dirty)
+    {
+        Accumulator const &previous = stack[index];
+        Accumulator &next = stack[++index];
+
+        for (Color perspective : {White, Black})
+        {
+            // Every feature depends on our king square, so a king
+            // move means recomputing this perspective from scratch
+            bool king_moved = false;
+            for (int i = 0; i < dirty.total_removed; i++)
+                king_moved |= dirty.removed[i] == make_piece(King, perspective);
+
+            if (king_moved)
+            {
+                refresh_perspective(next, position, perspective);
+                continue;
+            }
+
+            int16_t *values = next.values[perspective];
+            Square king = get_lsb(position.pieces.get_piece_bb<King>(perspective));
+
+            std::copy(previous.values[perspective], previous.values[perspective] + hidden_size, values);
+
+            for (int i = 0; i < dirty.total_removed; i++)
+            {
+                if (type_of(dirty.removed[i]) != King)
+                    sub_feature(values, feature_index(perspective, king, dirty.removed[i], dirty.removed_sq[i]));
+            }
+
+            for (int i = 0; i < dirty.total_added; i++)
+            {
+                if (type_of(dirty.added[i]) != King)
+                    add_feature(values, feature_index(perspective, king, dirty.added[i], dirty.added_sq[i]));
+            }
+        }
+    }
+
+    bool load(std::string const &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+
+        uint32_t header[6] = {0};
+        if (!read(file, header, 6))
+            return false;
+
+        if (header[0] != file_magic || header[1] != file_version || header[2] != total_features
+         || header[3] != hidden_size || header[4] != l1_size || header[5] != l2_size)
+            return false;
+
+        auto candidate = std::make_unique<Network>();
+        candidate->ft_weights.resize(size_t(total_features) * hidden_size);
+
+        bool valid = read(file, candidate->ft_bias, hidden_size)
+                  && read(file, candidate->ft_weights.data(), candidate->ft_weights.size())
+                  && read(file, candidate->l1_bias, l1_size)
+                  && read(file, &candidate->l1_weights[0][0], l1_size * 2 * hidden_size)
+                  && read(file, candidate->l2_bias, l2_size)
+                  && read(file, &candidate->l2_weights[0][0], l2_size * l1_size)
+                  && read(file, &candidate->out_bias, 1)
+                  && read(file, candidate->out_weights, l2_size);
+
+        if (!valid || file.peek() != std::ifstream::traits_type::eof())
+            return false;
+
+        network = std::move(candidate);
+        return true;
+    }
+
+    void unload()
+    {
+        network.reset();
+    }
+
+    bool enabled()
+    {
+        return network != nullptr;
+    }
+
+    int evaluate(Position const &position)
+    {
+        Accumulator const &accumulator = position.accumulators.current();
+        Color us = position.side;
+
+#ifndef NDEBUG
+        Accumulator fresh;
+        refresh_perspective(fresh, position, White);
+        refresh_perspective(fresh, position, Black);
+
+        if (std::memcmp(fresh.values, accumulator.values, sizeof(fresh.values)))
+        {
+            std::cerr << "incremental accumulator is out of sync\n" << position << std::endl;
+            std::abort();
+        }
+#endif
+
+        // The side to move always goes first, so the
+        // network knows whose turn it is
+        alignas(64) uint8_t input[2 * hidden_size];
+        for (int i = 0; i < hidden_size; i++)
+        {
+            input[i] = uint8_t(std::clamp<int>(accumulator.values[us][i], 0, activation_max));
+            input[hidden_size + i] = uint8_t(std::clamp<int>(accumulator.values[!us][i], 0, activation_max));
+        }
+
+        alignas(64) uint8_t l1[l1_size];
+        alignas(64) uint8_t l2[l2_size];
+
+        forward<2 * hidden_size, l1_size>(input, network->l1_bias, network->l1_weights, l1);
+        forward<l1_size, l2_size>(l1, network->l2_bias, network->l2_weights, l2);
+
+        int32_t output = network->out_bias + SIMD::kernels.dot(l2, network->out_weights, l2_size);
+
+        return std::clamp(output / output_scale, -max_score, max_score);
+    }
+}
@@ -0,0 +1,119 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "misc.h"
+#include "piece.h"
+#include "Square.h"
+#include <array>
+#include <string>
+
+// Efficiently updatable neural network evaluation
+//
+// The network uses HalfKP features, every non-king piece is seen relative to
+// the king of the perspective: king square x piece (5 types x 2 colors) x
+// square. The first layer (the feature transformer) is kept up to date
+// incrementally in an accumulator for each perspective, the two
+// accumulators are then fed through two small int8 layers
+//
+// File format (little endian)
+//  header        : uint32 magic "BGNN", uint32 version, uint32 feature
+//                  count, uint32 hidden size, uint32 l1 size, uint32 l2 size
+//  transformer   : int16 bias[hidden], int16 weights[features][hidden]
+//  l1            : int32 bias[l1], int8 weights[l1][2 * hidden]
+//  l2            : int32 bias[l2], int8 weights[l2][l1]
+//  output        : int32 bias, int8 weights[l2]
+namespace NNUE
+{
+    constexpr int total_features = total_squares * 10 * total_squares;
+    constexpr int hidden_size = 256;
+    constexpr int l1_size = 32;
+    constexpr int l2_size = 32;
+
+    struct alignas(64) Accumulator
+    {
+        int16_t values[total_colors][hidden_size];
+    };
+
+    // Pieces taken off and put on the board by a single move. A capture
+    // removes two pieces, castling moves two and a promotion swaps one
+    struct DirtyPieces
+    {
+        int total_removed = 0;
+        int total_added = 0;
+
+        Piece removed[2];
+        Square removed_sq[2];
+        Piece added[2];
+        Square added_sq[2];
+
+        void remove(Piece piece, Square sq)
+        {
+            removed[total_removed] = piece;
+            removed_sq[total_removed++] = sq;
+        }
+
+        void add(Piece piece, Square sq)
+        {
+            added[total_added] = piece;
+            added_sq[total_added++] = sq;
+        }
+    };
+
+    // One accumulator per ply. Making a move pushes an updated copy of the
+    // current accumulator and unmaking it just pops it again
+    class AccumulatorStack
+    {
+    public:
+        // Recompute the accumulator from scratch and
+        // make it the root of the stack
+        void refresh(Position const &);
+
+        // Push the accumulator for the position after a move
+        // has been made, the board has to be updated already
+        void push(Position const &, DirtyPieces const &);
+
+        void pop()
+        {
+            index--;
+        }
+
+        Accumulator const &current() const
+        {
+            return stack[index];
+        }
+
+    private:
+        std::array<Accumulator, 128> stack;
+        int index = 0;
+    };
+
+    // Load a network from a file. Returns false and keeps
+    // the previous network if the file is not valid
+    bool load(std::string const &path);
+
+    // Drop the loaded network, evaluation goes
+    // back to the handcrafted evaluation
+    void unload();
+
+    // True once a network has been loaded, evaluation then goes through
+    // the network instead of the handcrafted evaluation
+    bool enabled();
+
+    // Evaluation from the side to move's point of view
+    int evaluate(Position const &);
+}
@@ -0,0 +1,45 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "misc.h"
+
+// Everything the evaluation knows about the pawn structure that
+// doesn't depend on the other pieces
+struct PawnEntry
+{
+    uint64_t key = 0;
+    uint64_t passed[total_colors] = {0};
+    int score = 0;
+    uint8_t attack_count[total_colors] = {0};
+};
+
+// Pawn structures repeat across most of the tree, so each search thread
+// keeps its own small table of them indexed by the pawn zobrist key
+class PawnTable
+{
+public:
+    static constexpr int size = 1 << 14;
+
+    PawnEntry &probe(uint64_t key)
+    {
+        return entries[key & (size - 1)];
+    }
+
+private:
+    PawnEntry entries[size];
+};
@@ -0,0 +1,152 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "perft.h"
+#include "position.h"
+#include "movegen.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace
+{
+    // The count is stored next to its key xor the count, so a torn
+    // write from another thread fails the key check instead of
+    // returning the wrong number
+    struct PerftEntry
+    {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> nodes;
+    };
+
+    class PerftTable
+    {
+    public:
+        explicit PerftTable(int mb)
+        {
+            uint64_t bytes = uint64_t(std::clamp(mb, 1, 65536)) << 20;
+
+            size = 1;
+            while (size * 2 * sizeof(PerftEntry) <= bytes)
+                size *= 2;
+
+            entries.reset(new PerftEntry[size]());
+        }
+
+        bool probe(uint64_t key, int depth, uint64_t &nodes) const
+        {
+            key = depth_key(key, depth);
+            PerftEntry const &entry = entries[key & (size - 1)];
+
+            uint64_t check = entry.check.load(std::memory_order_relaxed);
+            nodes = entry.nodes.load(std::memory_order_relaxed);
+            return (check ^ nodes) == key;
+        }
+
+        void store(uint64_t key, int depth, uint64_t nodes)
+        {
+            key = depth_key(key, depth);
+            PerftEntry &entry = entries[key & (size - 1)];
+
+            entry.check.store(key ^ nodes, std::memory_order_relaxed);
+            entry.nodes.store(nodes, std::memory_order_relaxed);
+        }
+
+    private:
+        std::unique_ptr<PerftEntry[]> entries;
+        uint64_t size;
+
+        static uint64_t depth_key(uint64_t key, int depth)
+        {
+            return key ^ (uint64_t(depth) * 0x9e3779b97f4a7c15ull);
+        }
+    };
+
+    uint64_t count(Position &position, int depth, PerftTable &table)
+    {
+        uint64_t nodes = 0;
+
+        if (depth > 1 && table.probe(position.key.data(), depth, nodes))
+            return nodes;
+
+        MoveGenerator gen;
+        gen.generate(position);
+
+        // The generator is legal, so the last ply is just the number of moves
+        if (depth == 1)
+            return gen.movelist.size();
+
+        nodes = 0;
+
+        for (Move move : gen.movelist)
+        {
+            position.apply_move(move);
+            nodes += count(position, depth - 1, table);
+            position.revert_move();
+        }
+
+        table.store(position.key.data(), depth, nodes);
+        return nodes;
+    }
+}
+
+namespace Perft
+{
+    std::vector<std::pair<Move, uint64_t>> divide(Position const &position, Options const &options)
+    {
+        auto root = std::make_unique<Position>(position);
+
+        MoveGenerator gen;
+        gen.generate(*root);
+
+        std::vector<std::pair<Move, uint64_t>> results;
+        for (Move move : gen.movelist)
+            results.emplace_back(move, 1);
+
+        if (options.depth <= 1)
+            return results;
+
+        PerftTable table(options.hash);
+        std::atomic<size_t> next{0};
+
+        // Each thread takes the next unclaimed root move, so a few
+        // large subtrees don't leave the other threads idle
+        auto worker = [&]()
+        {
+            auto local = std::make_unique<Position>(position);
+
+            for (size_t i = next++; i < results.size(); i = next++)
+            {
+                local->apply_move(results[i].first);
+                results[i].second = count(*local, options.depth - 1, table);
+                local->revert_move();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int i = 1; i < std::max(options.threads, 1); i++)
+            workers.emplace_back(worker);
+
+        worker();
+
+        for (auto &thread : workers)
+            thread.join();
+
+        return results;
+    }
+}
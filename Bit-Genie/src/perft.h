@@ -0,0 +1,37 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "misc.h"
+#include <utility>
+#include <vector>
+
+// Perft with bulk counting at the leaves, a table of subtree counts keyed
+// by (zobrist key, depth) shared by all threads, and the root moves
+// split between the threads
+namespace Perft
+{
+    struct Options
+    {
+        int depth = 1;
+        int threads = 1;
+        int hash = 64; // MB
+    };
+
+    // Leaf count below every root move, in move generation order
+    std::vector<std::pair<Move, uint64_t>> divide(Position const &, Options const &);
+}
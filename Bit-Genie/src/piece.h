@@ -85,7 +85,7 @@ inline PieceType type_of(Piece piece)
     return lt[piece];
 }
 
-inline Color operator!(Color color)
+constexpr Color operator!(Color color)
 {
     return static_cast<Color>(!to_int(color));
 }
\ No newline at end of file
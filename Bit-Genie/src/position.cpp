@@ -32,6 +32,7 @@ Position::Position()
 void Position::reset()
 {
     key.reset();
+    pawn_key.reset();
     pieces.reset();
     castle_rights.reset();
     reset_halfmoves();
@@ -107,7 +108,11 @@ bool Position::set_fen(std::string_view fen)
     }
 
     key.generate(*this);
+    pawn_key.generate_pawns(*this);
+    psqt_score = PSQT::evaluate(pieces);
+    material_key = Material::generate_key(pieces);
     history.total = 0;
+    accumulators.refresh(*this);
     return valid;
 }
 
@@ -139,10 +144,11 @@ static inline bool is_double_push(Square from, Square to)
     return (from ^ to) == 16;
 }
 
+template <Color us>
 void Position::update_ep(Square to)
 {
-    uint64_t potential = BitMask::pawn_attacks[side][to ^ 8];
-    uint64_t enemy_pawns = pieces.get_piece_bb<Pawn>(!side);
+    uint64_t potential = BitMask::pawn_attacks[us][to ^ 8];
+    uint64_t enemy_pawns = pieces.get_piece_bb<Pawn>(!us);
 
     if (potential & enemy_pawns)
     {
@@ -151,22 +157,21 @@ void Position::update_ep(Square to)
     }
 }
 
+template <Color us>
 Piece Position::apply_enpassant(Move move)
 {
+    constexpr Piece from_pce = us == White ? wPawn : bPawn;
+    constexpr Piece captured = us == White ? bPawn : wPawn;
+
     reset_halfmoves();
 
     Square from = move_from(move);
     Square to = move_to(move);
     Square ep = to_sq(to_int(move_to(move)) ^ 8);
 
-    Piece from_pce = pieces.squares[from];
-    Piece captured = pieces.squares[ep];
-
-    pieces.bitboards[type_of(from_pce)] ^= (1ull << from) | (1ull << to);
-    pieces.colors[color_of(from_pce)] ^= (1ull << from) | (1ull << to);
-
-    pieces.bitboards[type_of(captured)] ^= (1ull << ep);
-    pieces.colors[color_of(captured)] ^= (1ull << ep);
+    pieces.bitboards[Pawn] ^= (1ull << from) | (1ull << to) | (1ull << ep);
+    pieces.colors[us] ^= (1ull << from) | (1ull << to);
+    pieces.colors[!us] ^= (1ull << ep);
 
     pieces.squares[to] = from_pce;
     pieces.squares[from] = Empty;
@@ -176,9 +181,17 @@ Piece Position::apply_enpassant(Move move)
     key.hash_piece(to, from_pce);
     key.hash_piece(ep, captured);
 
+    pawn_key.hash_piece(from, from_pce);
+    pawn_key.hash_piece(to, from_pce);
+    pawn_key.hash_piece(ep, captured);
+
+    psqt_score += PSQT::score(from_pce, to) - PSQT::score(from_pce, from) - PSQT::score(captured, ep);
+    material_key -= Material::piece_key(captured);
+
     return captured;
 }
 
+template <Color us>
 void Position::revert_normal_move(Move move, Piece captured)
 {
     Square from = move_from(move);
@@ -187,18 +200,19 @@ void Position::revert_normal_move(Move move, Piece captured)
     Piece from_pce = pieces.squares[to];
 
     pieces.bitboards[type_of(from_pce)] ^= ((1ull << from) | (1ull << to));
-    pieces.colors[color_of(from_pce)] ^= ((1ull << from) | (1ull << to));
+    pieces.colors[us] ^= ((1ull << from) | (1ull << to));
 
     if (!(captured == Empty))
     {
         pieces.bitboards[type_of(captured)] ^= (1ull << to);
-        pieces.colors[color_of(captured)] ^= (1ull << to);
+        pieces.colors[!us] ^= (1ull << to);
     }
 
     pieces.squares[from] = pieces.squares[to];
     pieces.squares[to] = captured;
 }
 
+template <Color us>
 void Position::revert_enpassant(Move move, Piece captured)
 {
     Square from = move_from(move);
@@ -206,13 +220,10 @@ void Position::revert_enpassant(Move move, Piece captured)
 
     Square ep = to_sq(to_int(move_to(move)) ^ 8);
     uint64_t ep_bb = 1ull << to_int(ep);
-    Piece from_pce = pieces.squares[to];
 
-    pieces.bitboards[type_of(from_pce)] ^= ((1ull << from) | (1ull << to));
-    pieces.colors[color_of(from_pce)] ^= ((1ull << from) | (1ull << to));
-
-    pieces.bitboards[type_of(captured)] ^= ep_bb;
-    pieces.colors[color_of(captured)] ^= ep_bb;
+    pieces.bitboards[Pawn] ^= (1ull << from) | (1ull << to) | ep_bb;
+    pieces.colors[us] ^= (1ull << from) | (1ull << to);
+    pieces.colors[!us] ^= ep_bb;
 
     pieces.squares[ep] = captured;
     pieces.squares[from] = pieces.squares[to];
@@ -255,6 +266,12 @@ void Position::perft(int depth, uint64_t &nodes, bool root)
     }
 }
 
+bool Position::move_is_legal(Move move)
+{
+    return side == White ? move_is_legal<White>(move) : move_is_legal<Black>(move);
+}
+
+template <Color us>
 bool Position::move_is_legal(Move move)
 {
     if (!move)
@@ -265,16 +282,16 @@ bool Position::move_is_legal(Move move)
 
     if (move_flag(move) == MoveFlag::normal || move_flag(move) == MoveFlag::promotion)
     {
-        if (pieces.squares[from] == wKing || pieces.squares[from] == bKing) // Normal king moves
+        if (pieces.squares[from] == make_piece(King, us)) // Normal king moves
         {
             uint64_t occupancy = total_occupancy() ^ (1ull << from);
-            return !Attacks::square_attacked(*this, to, !side, occupancy);
+            return !Attacks::square_attacked(*this, to, !us, occupancy);
         }
 
         else // Normal non-king moves
         {
             uint64_t occupancy = total_occupancy() ^ (1ull << from) ^ (1ull << to);
-            uint64_t enemy = enemy_bb();
+            uint64_t enemy = pieces.colors[!us];
 
             Piece captured = pieces.squares[to];
 
@@ -290,25 +307,25 @@ bool Position::move_is_legal(Move move)
             uint64_t rooks = pieces.bitboards[Rook] & enemy;
             uint64_t queens = pieces.bitboards[Queen] & enemy;
 
-            Square king = get_lsb(pieces.bitboards[King] & friend_bb());
+            Square king = get_lsb(pieces.get_piece_bb<King>(us));
 
             bishops |= queens;
             rooks |= queens;
 
-            return !((BitMask::pawn_attacks[side][king] & pawns) || (Attacks::bishop(king, occupancy) & bishops) || (Attacks::rook(king, occupancy) & rooks) || (Attacks::knight(king) & knights));
+            return !((BitMask::pawn_attacks[us][king] & pawns) || (Attacks::bishop(king, occupancy) & bishops) || (Attacks::rook(king, occupancy) & rooks) || (Attacks::knight(king) & knights));
         }
     }
 
     else if (move_flag(move) == MoveFlag::castle)
     {
-        return !Attacks::square_attacked(*this, to, !side);
+        return !Attacks::square_attacked(*this, to, !us);
     }
 
     else
     {
         Square ep = to_sq(to ^ 8);
         uint64_t occupancy = total_occupancy() ^ (1ull << from) ^ (1ull << to) ^ (1ull << ep);
-        uint64_t enemy = enemy_bb() ^ (1ull << ep);
+        uint64_t enemy = pieces.colors[!us] ^ (1ull << ep);
 
         uint64_t pawns = pieces.bitboards[Pawn] & enemy;
         uint64_t knights = pieces.bitboards[Knight] & enemy;
@@ -316,62 +333,67 @@ bool Position::move_is_legal(Move move)
         uint64_t rooks = pieces.bitboards[Rook] & enemy;
         uint64_t queens = pieces.bitboards[Queen] & enemy;
 
-        Square king = get_lsb(pieces.bitboards[King] & friend_bb());
+        Square king = get_lsb(pieces.get_piece_bb<King>(us));
 
         bishops |= queens;
         rooks |= queens;
 
-        return !((BitMask::pawn_attacks[side][king] & pawns) || (Attacks::bishop(king, occupancy) & bishops) || (Attacks::rook(king, occupancy) & rooks) || (Attacks::knight(king) & knights));
+        return !((BitMask::pawn_attacks[us][king] & pawns) || (Attacks::bishop(king, occupancy) & bishops) || (Attacks::rook(king, occupancy) & rooks) || (Attacks::knight(king) & knights));
     }
 
     return true;
 }
 
-Piece Position::apply_castle(Move move)
-{
-    auto old_castle = castle_rights;
-    Square from = move_from(move);
-    Square to = move_to(move);
-    Square rook_from = bad_sq, rook_to = bad_sq;
-    Color col = White;
+template bool Position::move_is_legal<White>(Move);
+template bool Position::move_is_legal<Black>(Move);
 
-    switch (to)
+// Find the rook squares for a castle move from the square the king
+// lands on, and return the color of the side castling
+static Color castle_rook_squares(Square king_to, Square &rook_from, Square &rook_to)
+{
+    switch (king_to)
     {
     case C1:
         rook_from = A1;
         rook_to = D1;
-        col = White;
-        break;
+        return White;
 
     case G1:
         rook_from = H1;
         rook_to = F1;
-        col = White;
-        break;
+        return White;
 
     case C8:
         rook_from = A8;
         rook_to = D8;
-        col = Black;
-        break;
+        return Black;
 
     case G8:
         rook_from = H8;
         rook_to = F8;
-        col = Black;
-        break;
+        return Black;
 
     default:
         assert(false);
-        break;
+        return White;
     }
+}
 
-    PieceType rook = type_of(pieces.squares[rook_from]);
-    PieceType king = type_of(pieces.squares[from]);
+template <Color us>
+Piece Position::apply_castle(Move move)
+{
+    constexpr Piece king = us == White ? wKing : bKing;
+    constexpr Piece rook = us == White ? wRook : bRook;
 
-    pieces.bitboards[king] ^= (1ull << from) ^ (1ull << to);
-    pieces.bitboards[rook] ^= (1ull << rook_from) ^ (1ull << rook_to);
-    pieces.colors[col] ^= (1ull << from) ^ (1ull << to) ^ (1ull << rook_from) ^ (1ull << rook_to);
+    auto old_castle = castle_rights;
+    Square from = move_from(move);
+    Square to = move_to(move);
+    Square rook_from = bad_sq, rook_to = bad_sq;
+    castle_rook_squares(to, rook_from, rook_to);
+
+    pieces.bitboards[King] ^= (1ull << from) ^ (1ull << to);
+    pieces.bitboards[Rook] ^= (1ull << rook_from) ^ (1ull << rook_to);
+    pieces.colors[us] ^= (1ull << from) ^ (1ull << to) ^ (1ull << rook_from) ^ (1ull << rook_to);
 
     pieces.squares[to] = pieces.squares[from];
     pieces.squares[from] = Empty;
@@ -381,59 +403,29 @@ Piece Position::apply_castle(Move move)
 
     castle_rights.update(move);
 
-    key.hash_piece(from, make_piece(king, col));
-    key.hash_piece(to, make_piece(king, col));
-    key.hash_piece(rook_from, make_piece(rook, col));
-    key.hash_piece(rook_to, make_piece(rook, col));
+    key.hash_piece(from, king);
+    key.hash_piece(to, king);
+    key.hash_piece(rook_from, rook);
+    key.hash_piece(rook_to, rook);
     key.hash_castle(old_castle, castle_rights);
 
+    psqt_score += PSQT::score(king, to) - PSQT::score(king, from);
+    psqt_score += PSQT::score(rook, rook_to) - PSQT::score(rook, rook_from);
+
     return Empty;
 }
 
+template <Color us>
 void Position::revert_castle(Move move)
 {
     Square from = move_from(move);
     Square to = move_to(move);
     Square rook_from = bad_sq, rook_to = bad_sq;
-    Color col = White;
+    castle_rook_squares(to, rook_from, rook_to);
 
-    switch (to)
-    {
-    case C1:
-        rook_from = A1;
-        rook_to = D1;
-        col = White;
-        break;
-
-    case G1:
-        rook_from = H1;
-        rook_to = F1;
-        col = White;
-        break;
-
-    case C8:
-        rook_from = A8;
-        rook_to = D8;
-        col = Black;
-        break;
-
-    case G8:
-        rook_from = H8;
-        rook_to = F8;
-        col = Black;
-        break;
-
-    default:
-        assert(false);
-        break;
-    }
-
-    PieceType rook = type_of(pieces.squares[rook_to]);
-    PieceType king = type_of(pieces.squares[to]);
-
-    pieces.bitboards[king] ^= (1ull << from) ^ (1ull << to);
-    pieces.bitboards[rook] ^= (1ull << rook_from) ^ (1ull << rook_to);
-    pieces.colors[col] ^= (1ull << from) ^ (1ull << to) ^ (1ull << rook_from) ^ (1ull << rook_to);
+    pieces.bitboards[King] ^= (1ull << from) ^ (1ull << to);
+    pieces.bitboards[Rook] ^= (1ull << rook_from) ^ (1ull << rook_to);
+    pieces.colors[us] ^= (1ull << from) ^ (1ull << to) ^ (1ull << rook_from) ^ (1ull << rook_to);
 
     pieces.squares[from] = pieces.squares[to];
     pieces.squares[to] = Empty;
@@ -442,24 +434,26 @@ void Position::revert_castle(Move move)
     pieces.squares[rook_to] = Empty;
 }
 
+template <Color us>
 Piece Position::apply_normal_move(Move move)
 {
+    constexpr Piece pawn = us == White ? wPawn : bPawn;
+
     CastleRights old_castle = castle_rights;
     Square from = move_from(move);
     Square to = move_to(move);
     Piece from_pce = pieces.squares[from];
 
     PieceType from_pce_t = type_of(from_pce);
-    Color from_pce_c = color_of(from_pce);
 
     Piece captured = pieces.squares[to];
 
-    if (type_of(from_pce) == Pawn)
+    if (from_pce == pawn)
     {
         reset_halfmoves();
 
         if (is_double_push(from, to))
-            update_ep(to);
+            update_ep<us>(to);
     }
 
     if (captured != Empty)
@@ -467,12 +461,17 @@ Piece Position::apply_normal_move(Move move)
         reset_halfmoves();
 
         pieces.bitboards[type_of(captured)] ^= (1ull << to);
-        pieces.colors[color_of(captured)] ^= (1ull << to);
+        pieces.colors[!us] ^= (1ull << to);
         key.hash_piece(to, captured);
+        psqt_score -= PSQT::score(captured, to);
+        material_key -= Material::piece_key(captured);
+
+        if (type_of(captured) == Pawn)
+            pawn_key.hash_piece(to, captured);
     }
 
     pieces.bitboards[from_pce_t] ^= ((1ull << from) | (1ull << to));
-    pieces.colors[from_pce_c] ^= ((1ull << from) | (1ull << to));
+    pieces.colors[us] ^= ((1ull << from) | (1ull << to));
 
     pieces.squares[to] = pieces.squares[from];
     pieces.squares[from] = Empty;
@@ -483,20 +482,27 @@ Piece Position::apply_normal_move(Move move)
     key.hash_piece(to, from_pce);
     key.hash_castle(old_castle, castle_rights);
 
+    psqt_score += PSQT::score(from_pce, to) - PSQT::score(from_pce, from);
+
+    if (from_pce == pawn)
+    {
+        pawn_key.hash_piece(from, from_pce);
+        pawn_key.hash_piece(to, from_pce);
+    }
+
     return captured;
 }
 
+template <Color us>
 Piece Position::apply_promotion(Move move)
 {
+    constexpr Piece from_pce = us == White ? wPawn : bPawn;
+
     reset_halfmoves();
 
     CastleRights old_castle = castle_rights;
     Square from = move_from(move);
     Square to = move_to(move);
-    Piece from_pce = pieces.squares[from];
-
-    PieceType from_pce_t = type_of(from_pce);
-    Color from_pce_c = color_of(from_pce);
 
     PieceType prom_pce = move_promoted(move);
 
@@ -505,51 +511,103 @@ Piece Position::apply_promotion(Move move)
     if (captured != Empty)
     {
         pieces.bitboards[type_of(captured)] ^= (1ull << to);
-        pieces.colors[color_of(captured)] ^= (1ull << to);
+        pieces.colors[!us] ^= (1ull << to);
         key.hash_piece(to, captured);
+        psqt_score -= PSQT::score(captured, to);
+        material_key -= Material::piece_key(captured);
     }
 
-    pieces.bitboards[from_pce_t] ^= (1ull << from);
+    pieces.bitboards[Pawn] ^= (1ull << from);
     pieces.bitboards[prom_pce] ^= (1ull << to);
-    pieces.colors[from_pce_c] ^= ((1ull << from) | (1ull << to));
+    pieces.colors[us] ^= ((1ull << from) | (1ull << to));
 
     pieces.squares[from] = Empty;
-    pieces.squares[to] = make_piece(prom_pce, from_pce_c);
+    pieces.squares[to] = make_piece(prom_pce, us);
 
     castle_rights.update(move);
 
     key.hash_piece(from, from_pce);
-    key.hash_piece(to, make_piece(prom_pce, from_pce_c));
+    key.hash_piece(to, make_piece(prom_pce, us));
     key.hash_castle(old_castle, castle_rights);
 
+    pawn_key.hash_piece(from, from_pce);
+    psqt_score += PSQT::score(make_piece(prom_pce, us), to) - PSQT::score(from_pce, from);
+    material_key += Material::piece_key(make_piece(prom_pce, us)) - Material::piece_key(from_pce);
+
     return captured;
 }
 
+template <Color us>
 void Position::revert_promotion(Move move, Piece captured)
 {
+    constexpr Piece original = us == White ? wPawn : bPawn;
+
     Square from = move_from(move);
     Square to = move_to(move);
 
-    Piece original = make_piece(PieceType::Pawn, !side);
     Piece prom_pce = pieces.squares[to];
 
-    pieces.bitboards[type_of(original)] ^= (1ull << from);
-    pieces.colors[color_of(original)] ^= (1ull << from) ^ (1ull << to);
+    pieces.bitboards[Pawn] ^= (1ull << from);
+    pieces.colors[us] ^= (1ull << from) ^ (1ull << to);
 
     pieces.bitboards[type_of(prom_pce)] ^= (1ull << to);
 
     if (captured != Empty)
     {
         pieces.bitboards[type_of(captured)] ^= (1ull << to);
-        pieces.colors[color_of(captured)] ^= (1ull << to);
+        pieces.colors[!us] ^= (1ull << to);
     }
 
     pieces.squares[from] = original;
     pieces.squares[to] = captured;
 }
 
+// Pieces the move takes off and puts on the board,
+// needed before the board is changed
+NNUE::DirtyPieces Position::dirty_pieces(Move move) const
+{
+    NNUE::DirtyPieces dirty;
+
+    Square from = move_from(move);
+    Square to = move_to(move);
+    MoveFlag flag = move_flag(move);
+    Piece moving = pieces.squares[from];
+
+    dirty.remove(moving, from);
+
+    if (flag == MoveFlag::castle)
+    {
+        Square rook_from = bad_sq, rook_to = bad_sq;
+        Color col = castle_rook_squares(to, rook_from, rook_to);
+
+        dirty.remove(make_piece(Rook, col), rook_from);
+        dirty.add(make_piece(Rook, col), rook_to);
+    }
+    else if (flag == MoveFlag::enpassant)
+        dirty.remove(pieces.squares[to ^ 8], to_sq(to ^ 8));
+
+    else if (pieces.squares[to] != Empty)
+        dirty.remove(pieces.squares[to], to);
+
+    dirty.add(flag == MoveFlag::promotion ? make_piece(move_promoted(move), side) : moving, to);
+    return dirty;
+}
+
+void Position::apply_move(Move move)
+{
+    if (side == White)
+        apply_move<White>(move);
+    else
+        apply_move<Black>(move);
+}
+
+template <Color us>
 void Position::apply_move(Move move)
 {
+    NNUE::DirtyPieces dirty;
+    if (NNUE::enabled())
+        dirty = dirty_pieces(move);
+
     auto &undo = save(move);
 
     if (ep_sq != Square::bad_sq)
@@ -561,18 +619,21 @@ void Position::apply_move(Move move)
     MoveFlag type = move_flag(move);
 
     if (type == MoveFlag::normal)
-        undo.captured = apply_normal_move(move);
+        undo.captured = apply_normal_move<us>(move);
 
     else if (type == MoveFlag::enpassant)
-        undo.captured = apply_enpassant(move);
+        undo.captured = apply_enpassant<us>(move);
 
     else if (type == MoveFlag::castle)
-        undo.captured = apply_castle(move);
+        undo.captured = apply_castle<us>(move);
     else
-        undo.captured = apply_promotion(move);
+        undo.captured = apply_promotion<us>(move);
 
     key.hash_side();
     switch_players();
+
+    if (NNUE::enabled())
+        accumulators.push(*this, dirty);
 }
 
 void Position::revert_move()
@@ -582,21 +643,80 @@ void Position::revert_move()
 
     restore(move, captured);
 
+    // The side to move is still the opponent of the one that moved
+    if (side == White)
+        revert_move<Black>(move, captured);
+    else
+        revert_move<White>(move, captured);
+
+    switch_players();
+
+    if (NNUE::enabled())
+        accumulators.pop();
+}
+
+template <Color us>
+void Position::revert_move(Move move, Piece captured)
+{
     MoveFlag type = move_flag(move);
 
     if (type == MoveFlag::normal)
-        revert_normal_move(move, captured);
+        revert_normal_move<us>(move, captured);
 
     else if (type == MoveFlag::enpassant)
-        revert_enpassant(move, captured);
+        revert_enpassant<us>(move, captured);
 
     else if (type == MoveFlag::castle)
-        revert_castle(move);
+        revert_castle<us>(move);
 
     else
-        revert_promotion(move, captured);
+        revert_promotion<us>(move, captured);
+}
 
-    switch_players();
+uint64_t Position::key_after(Move move) const
+{
+    ZobristKey next = key;
+
+    Square from = move_from(move);
+    Square to = move_to(move);
+    MoveFlag flag = move_flag(move);
+    Piece moving = pieces.squares[from];
+
+    if (ep_sq != Square::bad_sq)
+        next.hash_ep(ep_sq);
+
+    if (flag == MoveFlag::castle)
+    {
+        Square rook_from = bad_sq, rook_to = bad_sq;
+        Color col = castle_rook_squares(to, rook_from, rook_to);
+
+        next.hash_piece(rook_from, make_piece(Rook, col));
+        next.hash_piece(rook_to, make_piece(Rook, col));
+    }
+    else if (flag == MoveFlag::enpassant)
+        next.hash_piece(to_sq(to ^ 8), pieces.squares[to ^ 8]);
+
+    else if (pieces.squares[to] != Empty)
+        next.hash_piece(to, pieces.squares[to]);
+
+    next.hash_piece(from, moving);
+    next.hash_piece(to, flag == MoveFlag::promotion ? make_piece(move_promoted(move), side) : moving);
+
+    if (flag != MoveFlag::enpassant)
+    {
+        CastleRights updated = castle_rights;
+        updated.update(move);
+        next.hash_castle(castle_rights, updated);
+    }
+
+    if (type_of(moving) == Pawn && is_double_push(from, to))
+    {
+        if (BitMask::pawn_attacks[side][to ^ 8] & pieces.get_piece_bb<Pawn>(!side))
+            next.hash_ep(to_sq(to ^ 8));
+    }
+
+    next.hash_side();
+    return next.data();
 }
 
 bool Position::apply_move(std::string const &move)
@@ -608,7 +728,10 @@ bool Position::apply_move(std::string const &move)
     {
         if (print_move(m) == move)
         {
+            // Game moves are never taken back, so start the
+            // accumulator stack again from this position
             apply_move(m);
+            accumulators.refresh(*this);
             return true;
         }
     }
@@ -763,6 +886,9 @@ PositionHistory::Undo &Position::save(Move move)
 
     undo.move = move;
     undo.key = key;
+    undo.pawn_key = pawn_key;
+    undo.psqt_score = psqt_score;
+    undo.material_key = material_key;
     undo.ep_sq = ep_sq;
     undo.castle = castle_rights;
     undo.half_moves = half_moves;
@@ -777,6 +903,9 @@ void Position::restore()
     auto &undo = history.previous();
 
     key = undo.key;
+    pawn_key = undo.pawn_key;
+    psqt_score = undo.psqt_score;
+    material_key = undo.material_key;
     ep_sq = undo.ep_sq;
     castle_rights = undo.castle;
     half_moves = undo.half_moves;
@@ -789,6 +918,9 @@ void Position::restore(Move &move, Piece &captured)
     auto &undo = history.previous();
 
     key = undo.key;
+    pawn_key = undo.pawn_key;
+    psqt_score = undo.psqt_score;
+    material_key = undo.material_key;
     ep_sq = undo.ep_sq;
     castle_rights = undo.castle;
     half_moves = undo.half_moves;
@@ -20,6 +20,9 @@
 #include "castle_rights.h"
 #include "position_history.h"
 #include "zobrist.h"
+#include "nnue.h"
+#include "psqt.h"
+#include "material.h"
 
 class Position
 {
@@ -37,6 +40,10 @@ public:
 
     void apply_move(Move);
 
+    // Zobrist key of the position after the given move, computed
+    // without changing the board
+    uint64_t key_after(Move) const;
+
     void apply_move(Move, int &ply);
 
     void revert_move();
@@ -51,6 +58,9 @@ public:
 
     bool move_is_legal(Move);
 
+    template <Color us>
+    bool move_is_legal(Move);
+
     bool move_is_pseudolegal(Move);
 
     bool move_exists(Move);
@@ -72,8 +82,20 @@ public:
 
     ZobristKey key;
 
+    // Key of the pawns alone, used by the pawn hash table
+    ZobristKey pawn_key;
+
+    // Piece counts, see Material::piece_key
+    uint64_t material_key = 0;
+
+    // Packed material and piece square score of
+    // all pieces from white's point of view
+    int psqt_score = 0;
+
     PositionHistory history;
 
+    NNUE::AccumulatorStack accumulators;
+
 private:
     void reset();
 
@@ -92,24 +114,43 @@ private:
         side = !side;
     }
 
+    // The side making or taking back the move is a template parameter,
+    // apply_move and revert_move look at the side to move once
+    template <Color us>
+    void apply_move(Move);
+
+    template <Color us>
+    void revert_move(Move, Piece);
+
+    template <Color us>
     Piece apply_normal_move(Move);
 
+    template <Color us>
     Piece apply_enpassant(Move);
 
+    template <Color us>
     Piece apply_castle(Move);
 
+    template <Color us>
     Piece apply_promotion(Move);
 
+    template <Color us>
     void revert_normal_move(Move, Piece);
 
+    template <Color us>
     void revert_enpassant(Move, Piece);
 
+    template <Color us>
     void revert_castle(Move);
 
+    template <Color us>
     void revert_promotion(Move, Piece);
 
+    template <Color us>
     void update_ep(Square to);
 
+    NNUE::DirtyPieces dirty_pieces(Move) const;
+
     PositionHistory::Undo &save(Move = NullMove);
 
     void restore();
@@ -30,6 +30,9 @@ public:
         Square ep_sq = Square::bad_sq;
         CastleRights castle;
         ZobristKey key;
+        ZobristKey pawn_key;
+        uint64_t material_key = 0;
+        int psqt_score = 0;
         Piece captured;
         Move move;
     };
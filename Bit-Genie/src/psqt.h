@@ -0,0 +1,69 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "evalscores.h"
+#include "piece.h"
+#include "piece_manager.h"
+#include <array>
+
+// Material and piece square scores. They only change with the pieces
+// that move, so Position keeps their sum up to date incrementally
+namespace PSQT
+{
+    constexpr int piece_value[total_pieces]{
+        PawnEval::value, KnightEval::value, BishopEval::value, RookEval::value, QueenEval::value, 0};
+
+    constexpr int const *piece_psqt[total_pieces]{
+        PawnEval::psqt, KnightEval::psqt, BishopEval::psqt, RookEval::psqt, QueenEval::psqt, KingEval::psqt};
+
+    // Packed mg/eg score of every piece on every square from white's
+    // point of view. The tables are written from black's side
+    constexpr auto make_table()
+    {
+        std::array<std::array<int, total_squares>, total_pieces * total_colors> table{};
+
+        for (int type = 0; type < total_pieces; type++)
+        {
+            for (int sq = 0; sq < total_squares; sq++)
+            {
+                table[type][sq] = piece_value[type] + piece_psqt[type][sq ^ 56];
+                table[type + total_pieces][sq] = -(piece_value[type] + piece_psqt[type][sq]);
+            }
+        }
+        return table;
+    }
+
+    constexpr auto table = make_table();
+
+    inline int score(Piece piece, Square sq)
+    {
+        return table[piece][sq];
+    }
+
+    // From scratch, only used to check the incremental score
+    inline int evaluate(PieceManager const &pieces)
+    {
+        int score = 0;
+        for (int sq = 0; sq < total_squares; sq++)
+        {
+            if (pieces.squares[sq] != Empty)
+                score += table[pieces.squares[sq]][sq];
+        }
+        return score;
+    }
+}
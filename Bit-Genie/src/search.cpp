@@ -24,22 +24,26 @@
 #include <sstream>
 #include "evalscores.h"
 #include <cmath>
+#include <thread>
 
 int lmr_reductions_array[64][64]{0};
 
 std::atomic_bool SEARCH_ABORT = ATOMIC_VAR_INIT(false);
 
-namespace
+int mate_distance(int score)
 {
-    enum
+    if (score > 0)
     {
-        MinEval = -std::numeric_limits<int>::max(),
-        MaxEval = -MinEval,
-        MateEval = MaxEval - 1,
-        MaxPly = 64,
-        MinMateScore = MateEval - MaxPly,
-    };
+        return (MateEval - score) / 2 + 1;
+    }
+    else
+    {
+        return -(MateEval + score) / 2;
+    }
+}
 
+namespace
+{
     struct SearchResult
     {
         int score = MinEval;
@@ -74,7 +78,7 @@ namespace
         if ((position.history.is_drawn(position.key) || position.half_moves >= 100) && search.info.ply)
             return 0;
 
-        int stand_pat = eval_position(position);
+        int stand_pat = eval_position(position, alpha, beta);
 
         if (stand_pat >= beta)
             return beta;
@@ -136,14 +140,25 @@ namespace
         if ((position.history.is_drawn(position.key) || position.half_moves >= 100) && search.info.ply)
             return 0;
 
-        TEntry& entry = tt.retrieve(position);
+        TEntry entry;
+        search.info.tt_probes++;
 
-        if (entry.depth >= depth && entry.hash == position.key.data())
+        if (tt.retrieve(position, entry, search.info.ply))
         {
-            if (entry.flag == TEFlag::exact || 
-               (entry.flag == TEFlag::lower && entry.score >= beta) || 
-               (entry.flag == TEFlag::upper && entry.score <= alpha))
-                return { entry.score, (Move)entry.move };
+            search.info.tt_hits++;
+
+            // No cutoffs at the root, its move is sent as bestmove and the
+            // entry may belong to another position sharing the 18 key bits
+            if (entry.depth >= depth && search.info.ply)
+            {
+                if (entry.flag == TEFlag::exact || 
+                   (entry.flag == TEFlag::lower && entry.score >= beta) || 
+                   (entry.flag == TEFlag::upper && entry.score <= alpha))
+                {
+                    search.info.tt_cutoffs++;
+                    return { entry.score, (Move)entry.move };
+                }
+            }
         }
 
         bool in_check = position.king_in_check();
@@ -174,6 +189,11 @@ namespace
         for (Move move; picker.next(move);)
         {
             move_num++;
+
+            // Children at depth 1 drop straight into qsearch and never probe
+            if (depth > 1)
+                tt.prefetch(position.key_after(move));
+
             position.apply_move(move, search.info.ply);
 
             int score = 0;
@@ -245,23 +265,11 @@ namespace
             return 0;
 
         TEFlag flag = result.score <= original ? TEFlag::upper : result.score >= beta ? TEFlag::lower : TEFlag::upper;
-        tt.add(position, result.best_move, result.score, depth, flag);
+        search.info.tt_overwrites += tt.add(position, result.best_move, result.score, depth, flag, search.info.ply);
 
         return result;
     }
 
-    int mate_distance(int score)
-    {
-        if (score > 0)
-        {
-            return (MateEval - score) / 2 + 1;
-        }
-        else
-        {
-            return (MateEval + score) / 2 + 1;
-        }
-    }
-
     std::string print_score(int score)
     {
         std::stringstream o;
@@ -281,34 +289,36 @@ namespace
     {
         std::vector<Move> pv;
 
-        TEntry *entry = &tt.retrieve(position);
+        TEntry entry;
 
-        while (entry->hash == position.key.data() && depth != 0)
+        while (depth != 0 && tt.retrieve(position, entry, int(pv.size())))
         {
-            if (position.move_exists((Move)entry->move))
+            if (position.move_exists((Move)entry.move))
             {
-                position.apply_move((Move)entry->move);
-                pv.push_back((Move)entry->move);
+                position.apply_move((Move)entry.move);
+                pv.push_back((Move)entry.move);
                 depth--;
             }
             else
                 break;
-
-            entry = &tt.retrieve(position);
         }
 
         return pv;
     }
 
-    void print_info_string(Position &position, SearchResult &result, TTable &tt, Search &search, int depth)
+    void print_info_string(Position &position, SearchResult &result, TTable &tt, Search &search, int depth, uint64_t nodes)
     {
         using namespace std::chrono;
+        auto elapsed = duration_cast<milliseconds>(search.limits.stopwatch.elapsed_time()).count();
+
         std::cout << "info";
         std::cout << " depth " << depth;
         std::cout << " seldepth " << search.info.seldepth;
-        std::cout << " nodes " << search.info.nodes;
+        std::cout << " nodes " << nodes;
+        std::cout << " nps " << nodes * 1000 / std::max<int64_t>(elapsed, 1);
         std::cout << " score " << print_score(result.score);
-        std::cout << " time " << duration_cast<milliseconds>(search.limits.stopwatch.elapsed_time()).count();
+        std::cout << " hashfull " << tt.hashfull();
+        std::cout << " time " << elapsed;
         std::cout << " pv ";
 
         for (auto m : get_pv(position, tt, depth))
@@ -318,6 +328,63 @@ namespace
 
         std::cout << std::endl;
     }
+
+    // Iterative deepening loop for a Lazy SMP helper. Helpers share the
+    // transposition table with the main thread but own their killers, history,
+    // search info and evaluation tables. Odd helpers start one ply deeper so that the threads
+    // don't all search the same depths in lockstep
+    void helper_search(Position &position, Search &search, TTable &tt, EvalTables &tables, int id)
+    {
+        bind_eval_tables(tables);
+
+        for (int depth = 1 + (id & 1);
+             depth <= search.limits.max_depth;
+             depth++)
+        {
+            search.info.ply = 0;
+            search.info.nodes = 0;
+
+            SearchResult result = pvs(position, search, tt, depth);
+
+            if (search.limits.stopped)
+                break;
+
+            search.info.depth = depth;
+            search.info.best_move = result.best_move;
+        }
+    }
+
+    // Nodes are read while the helpers are still running, the counts
+    // are only used for reporting so a slightly stale value is fine
+    uint64_t total_nodes(Search const &search, std::vector<Search> const &helpers)
+    {
+        uint64_t nodes = search.info.total_nodes;
+        for (auto const &helper : helpers)
+            nodes += helper.info.total_nodes;
+        return nodes;
+    }
+
+    void print_hash_stats(Search const &search, std::vector<Search> const &helpers)
+    {
+        SearchInfo total = search.info;
+        for (auto const &helper : helpers)
+        {
+            total.tt_probes += helper.info.tt_probes;
+            total.tt_hits += helper.info.tt_hits;
+            total.tt_cutoffs += helper.info.tt_cutoffs;
+            total.tt_overwrites += helper.info.tt_overwrites;
+            total.tt_collisions += helper.info.tt_collisions;
+        }
+
+        std::cout << "info string hash";
+        std::cout << " probes " << total.tt_probes;
+        std::cout << " hits " << total.tt_hits;
+        std::cout << " (" << total.tt_hits * 100 / std::max<uint64_t>(total.tt_probes, 1) << "%)";
+        std::cout << " cutoffs " << total.tt_cutoffs;
+        std::cout << " overwrites " << total.tt_overwrites;
+        std::cout << " collisions " << total.tt_collisions;
+        std::cout << std::endl;
+    }
 }
 
 void init_lmr_array()
@@ -331,11 +398,23 @@ void init_lmr_array()
     }
 }
 
-void search_position(Position &position, Search search, TTable &tt)
+void search_position(Position &position, Search search, TTable &tt, std::vector<EvalTables> &tables)
 {
     SEARCH_ABORT = false;
+    bind_eval_tables(tables[0]);
+
+    // Helpers never look at the clock, they run until the main thread
+    // raises SEARCH_ABORT once it is done with its own search
+    Search helper = search;
+    helper.limits.time_set = false;
+
+    std::vector<Search> helpers(tables.size() - 1, helper);
+    std::vector<Position> positions(helpers.size(), position);
+    std::vector<std::thread> workers;
+
+    for (size_t i = 0; i < helpers.size(); i++)
+        workers.emplace_back(helper_search, std::ref(positions[i]), std::ref(helpers[i]), std::ref(tt), std::ref(tables[i + 1]), int(i + 1));
 
-    Move best_move = NullMove;
     for (int depth = 1;
          depth <= search.limits.max_depth;
          depth++)
@@ -345,16 +424,39 @@ void search_position(Position &position, Search search, TTable &tt)
 
         SearchResult result = pvs(position, search, tt, depth);
 
-    if (search.limits.stopped)
+        if (search.limits.stopped)
         {
             if (depth == 1)
                 std::cout << "stopped at depth 1\n";
             break;
         }
 
-        print_info_string(position, result, tt, search, depth);
-        best_move = result.best_move;
+        print_info_string(position, result, tt, search, depth, total_nodes(search, helpers));
+        search.info.depth = depth;
+        search.info.best_move = result.best_move;
+    }
+
+    SEARCH_ABORT = true;
+    for (auto &worker : workers)
+        worker.join();
+
+    // The main thread has the final say, unless a helper managed
+    // to complete a deeper iteration than it did
+    Move best_move = search.info.best_move;
+    int best_depth = search.info.depth;
+
+    for (auto const &h : helpers)
+    {
+        if (h.info.depth > best_depth && h.info.best_move != NullMove)
+        {
+            best_depth = h.info.depth;
+            best_move = h.info.best_move;
+        }
     }
+
+    if (search.hash_stats)
+        print_hash_stats(search, helpers);
+
     std::cout << "bestmove " << print_move(best_move) << std::endl;
 }
 
@@ -365,6 +467,8 @@ uint64_t bench_search_position(Position &position, TTable &tt)
     search.limits.time_set = false;
     SEARCH_ABORT = false;
 
+    tt.new_search();
+
     for (int depth = 1;
          depth <= 12;
          depth++)
@@ -374,4 +478,23 @@ uint64_t bench_search_position(Position &position, TTable &tt)
         pvs(position, search, tt, depth);
     }
     return search.info.total_nodes;
+}
+
+std::vector<int> search_scores(Position &position, TTable &tt, int depth)
+{
+    Search search;
+    search.limits.stopped = false;
+    search.limits.time_set = false;
+    SEARCH_ABORT = false;
+
+    tt.new_search();
+
+    std::vector<int> scores;
+    for (int iteration = 1; iteration <= depth; iteration++)
+    {
+        search.info.ply = 0;
+        search.info.nodes = 0;
+        scores.push_back(pvs(position, search, tt, iteration).score);
+    }
+    return scores;
 }
\ No newline at end of file
@@ -21,6 +21,17 @@
 #include "killer.h"
 #include "shistory.h"
 #include <atomic>
+#include <vector>
+
+// Scores have to fit in the 16 bits of a transposition table entry
+enum
+{
+    MaxEval = 32000,
+    MinEval = -MaxEval,
+    MateEval = MaxEval - 1,
+    MaxPly = 64,
+    MinMateScore = MateEval - MaxPly,
+};
 
 struct Search
 {
@@ -28,10 +39,21 @@ struct Search
     SearchLimits limits;
     Killers killers;
     SHistory history;
+    bool hash_stats = false;
 };
 
+// Moves to mate in a mate score as sent to the gui,
+// negative when the side to move is getting mated
+int mate_distance(int score);
+
 void init_lmr_array();
-void search_position(Position &, Search, TTable &tt);
+
+// Searches with one thread per set of evaluation tables
+void search_position(Position &, Search, TTable &tt, std::vector<EvalTables> &);
 uint64_t bench_search_position(Position &, TTable &);
 
+// Root score of every iteration of a fixed depth search,
+// used to check that mate distances are stable across depths
+std::vector<int> search_scores(Position &, TTable &, int depth);
+
 extern std::atomic_bool SEARCH_ABORT;
\ No newline at end of file
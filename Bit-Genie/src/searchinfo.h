@@ -17,16 +17,61 @@
 */
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <stdint.h>
+#include "move.h"
+
+// Node count the main thread reads from the helpers while they search.
+// Only the owning thread writes it, so counting is a relaxed load and
+// store rather than a locked add. Copies take a snapshot of the count
+class NodeCounter
+{
+public:
+    NodeCounter() = default;
+
+    NodeCounter(NodeCounter const &other)
+        : count(other)
+    {
+    }
+
+    NodeCounter &operator=(NodeCounter const &other)
+    {
+        count.store(other, std::memory_order_relaxed);
+        return *this;
+    }
+
+    void operator++(int)
+    {
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    operator uint64_t() const
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> count = 0;
+};
 
 struct SearchInfo
 {
-    uint64_t total_nodes = 0;
+    NodeCounter total_nodes;
     uint64_t nodes = 0;
     uint64_t total_cutoffs = 0;
+
+    // Transposition table statistics, collisions are counted
+    // when a hash move turns out not to be legal in the position
+    uint64_t tt_probes = 0;
+    uint64_t tt_hits = 0;
+    uint64_t tt_cutoffs = 0;
+    uint64_t tt_overwrites = 0;
+    uint64_t tt_collisions = 0;
+
     int ply = 0;
     int depth = 0;
     int seldepth = 0;
+    Move best_move = NullMove;
 
     void update_seldepth()
     {
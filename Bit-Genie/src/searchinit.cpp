@@ -7,7 +7,24 @@ void SearchInit::begin(Search &search, Position &position, TTable &tt)
         end();
 
     using std::ref;
-    worker = std::thread(search_position, ref(position), search, ref(tt));
+    worker = std::thread(search_position, ref(position), search, ref(tt), ref(tables));
+}
+
+void SearchInit::set_threads(int count)
+{
+    if (worker.joinable())
+        end();
+
+    tables.resize(count);
+}
+
+void SearchInit::clear_eval_caches()
+{
+    if (worker.joinable())
+        end();
+
+    for (auto &table : tables)
+        table.evals.clear();
 }
 
 void SearchInit::end()
@@ -17,12 +17,16 @@
 */
 #pragma once
 #include "misc.h"
+#include "eval.h"
 #include <thread>
+#include <vector>
 
 class SearchInit
 {
 public:
-    SearchInit() = default;
+    SearchInit() : tables(1)
+    {
+    }
 
     void begin(Search &, Position &, TTable &);
     void end();
@@ -31,6 +35,30 @@ public:
         return worker.joinable();
     }
 
+    // Every search thread keeps its evaluation tables
+    // across searches, one set is allocated per thread
+    void set_threads(int count);
+
+    int thread_count() const noexcept
+    {
+        return int(tables.size());
+    }
+
+    // Drop every cached evaluation of the search threads
+    void clear_eval_caches();
+
+    void set_hash_stats(bool enabled) noexcept
+    {
+        hash_stats = enabled;
+    }
+
+    bool reports_hash_stats() const noexcept
+    {
+        return hash_stats;
+    }
+
 private:
     std::thread worker;
+    std::vector<EvalTables> tables;
+    bool hash_stats = false;
 };
\ No newline at end of file
@@ -0,0 +1,337 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    using namespace SIMD;
+
+    void add_scalar(int16_t *values, int16_t const *weights, int size)
+    {
+        for (int i = 0; i < size; i++)
+            values[i] += weights[i];
+    }
+
+    void sub_scalar(int16_t *values, int16_t const *weights, int size)
+    {
+        for (int i = 0; i < size; i++)
+            values[i] -= weights[i];
+    }
+
+    int32_t dot_scalar(uint8_t const *input, int8_t const *weights, int size)
+    {
+        int32_t sum = 0;
+        for (int i = 0; i < size; i++)
+            sum += input[i] * weights[i];
+        return sum;
+    }
+
+    void affine_scalar(uint8_t const *input, int8_t const *weights, int32_t const *bias, int32_t *output, int inputs, int outputs)
+    {
+        for (int o = 0; o < outputs; o++)
+            output[o] = bias[o] + dot_scalar(input, weights + o * inputs, inputs);
+    }
+
+#ifdef SIMD_X86
+    // Unaligned loads and stores throughout, the cost is negligible
+    // on current cpus and callers don't have to care about alignment
+
+    __attribute__((target("sse4.1"))) void add_sse41(int16_t *values, int16_t const *weights, int size)
+    {
+        int i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            __m128i v = _mm_loadu_si128((__m128i const *)(values + i));
+            __m128i w = _mm_loadu_si128((__m128i const *)(weights + i));
+            _mm_storeu_si128((__m128i *)(values + i), _mm_add_epi16(v, w));
+        }
+        add_scalar(values + i, weights + i, size - i);
+    }
+
+    __attribute__((target("sse4.1"))) void sub_sse41(int16_t *values, int16_t const *weights, int size)
+    {
+        int i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            __m128i v = _mm_loadu_si128((__m128i const *)(values + i));
+            __m128i w = _mm_loadu_si128((__m128i const *)(weights + i));
+            _mm_storeu_si128((__m128i *)(values + i), _mm_sub_epi16(v, w));
+        }
+        sub_scalar(values + i, weights + i, size - i);
+    }
+
+    __attribute__((target("sse4.1"))) int32_t dot_sse41(uint8_t const *input, int8_t const *weights, int size)
+    {
+        __m128i ones = _mm_set1_epi16(1);
+        __m128i sum = _mm_setzero_si128();
+
+        int i = 0;
+        for (; i + 16 <= size; i += 16)
+        {
+            __m128i in = _mm_loadu_si128((__m128i const *)(input + i));
+            __m128i w = _mm_loadu_si128((__m128i const *)(weights + i));
+            __m128i pairs = _mm_maddubs_epi16(in, w);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pairs, ones));
+        }
+
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        return _mm_cvtsi128_si32(sum) + dot_scalar(input + i, weights + i, size - i);
+    }
+
+    // Four rows at a time share the input loads and
+    // are reduced together at the end
+    __attribute__((target("sse4.1"))) void affine_sse41(uint8_t const *input, int8_t const *weights, int32_t const *bias, int32_t *output, int inputs, int outputs)
+    {
+        __m128i ones = _mm_set1_epi16(1);
+        int o = 0;
+
+        for (; inputs % 16 == 0 && o + 4 <= outputs; o += 4)
+        {
+            int8_t const *row = weights + o * inputs;
+            __m128i sum[4] = {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+
+            for (int i = 0; i < inputs; i += 16)
+            {
+                __m128i in = _mm_loadu_si128((__m128i const *)(input + i));
+                for (int r = 0; r < 4; r++)
+                {
+                    __m128i w = _mm_loadu_si128((__m128i const *)(row + r * inputs + i));
+                    sum[r] = _mm_add_epi32(sum[r], _mm_madd_epi16(_mm_maddubs_epi16(in, w), ones));
+                }
+            }
+
+            __m128i total = _mm_hadd_epi32(_mm_hadd_epi32(sum[0], sum[1]), _mm_hadd_epi32(sum[2], sum[3]));
+            total = _mm_add_epi32(total, _mm_loadu_si128((__m128i const *)(bias + o)));
+            _mm_storeu_si128((__m128i *)(output + o), total);
+        }
+
+        for (; o < outputs; o++)
+            output[o] = bias[o] + dot_sse41(input, weights + o * inputs, inputs);
+    }
+
+    __attribute__((target("avx2"))) void add_avx2(int16_t *values, int16_t const *weights, int size)
+    {
+        int i = 0;
+        for (; i + 16 <= size; i += 16)
+        {
+            __m256i v = _mm256_loadu_si256((__m256i const *)(values + i));
+            __m256i w = _mm256_loadu_si256((__m256i const *)(weights + i));
+            _mm256_storeu_si256((__m256i *)(values + i), _mm256_add_epi16(v, w));
+        }
+        add_scalar(values + i, weights + i, size - i);
+    }
+
+    __attribute__((target("avx2"))) void sub_avx2(int16_t *values, int16_t const *weights, int size)
+    {
+        int i = 0;
+        for (; i + 16 <= size; i += 16)
+        {
+            __m256i v = _mm256_loadu_si256((__m256i const *)(values + i));
+            __m256i w = _mm256_loadu_si256((__m256i const *)(weights + i));
+            _mm256_storeu_si256((__m256i *)(values + i), _mm256_sub_epi16(v, w));
+        }
+        sub_scalar(values + i, weights + i, size - i);
+    }
+
+    __attribute__((target("avx2"))) int32_t hsum_avx2(__m256i sum)
+    {
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+        return _mm_cvtsi128_si32(half);
+    }
+
+    __attribute__((target("avx2"))) int32_t dot_avx2(uint8_t const *input, int8_t const *weights, int size)
+    {
+        __m256i ones = _mm256_set1_epi16(1);
+        __m256i sum = _mm256_setzero_si256();
+
+        int i = 0;
+        for (; i + 32 <= size; i += 32)
+        {
+            __m256i in = _mm256_loadu_si256((__m256i const *)(input + i));
+            __m256i w = _mm256_loadu_si256((__m256i const *)(weights + i));
+            __m256i pairs = _mm256_maddubs_epi16(in, w);
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(pairs, ones));
+        }
+
+        return hsum_avx2(sum) + dot_scalar(input + i, weights + i, size - i);
+    }
+
+    __attribute__((target("avx2"))) void affine_avx2(uint8_t const *input, int8_t const *weights, int32_t const *bias, int32_t *output, int inputs, int outputs)
+    {
+        __m256i ones = _mm256_set1_epi16(1);
+        int o = 0;
+
+        for (; inputs % 32 == 0 && o + 4 <= outputs; o += 4)
+        {
+            int8_t const *row = weights + o * inputs;
+            __m256i sum[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+
+            for (int i = 0; i < inputs; i += 32)
+            {
+                __m256i in = _mm256_loadu_si256((__m256i const *)(input + i));
+                for (int r = 0; r < 4; r++)
+                {
+                    __m256i w = _mm256_loadu_si256((__m256i const *)(row + r * inputs + i));
+                    sum[r] = _mm256_add_epi32(sum[r], _mm256_madd_epi16(_mm256_maddubs_epi16(in, w), ones));
+                }
+            }
+
+            __m256i lanes = _mm256_hadd_epi32(_mm256_hadd_epi32(sum[0], sum[1]), _mm256_hadd_epi32(sum[2], sum[3]));
+            __m128i total = _mm_add_epi32(_mm256_castsi256_si128(lanes), _mm256_extracti128_si256(lanes, 1));
+            total = _mm_add_epi32(total, _mm_loadu_si128((__m128i const *)(bias + o)));
+            _mm_storeu_si128((__m128i *)(output + o), total);
+        }
+
+        for (; o < outputs; o++)
+            output[o] = bias[o] + dot_avx2(input, weights + o * inputs, inputs);
+    }
+
+    // The gcc 12 avx512 headers pass _mm512_undefined values to the masked
+    // builtins, which trips the uninitialized warnings on every shuffle
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+    __attribute__((target("avx512f,avx512bw"))) void add_avx512(int16_t *values, int16_t const *weights, int size)
+    {
+        int i = 0;
+        for (; i + 32 <= size; i += 32)
+        {
+            __m512i v = _mm512_loadu_si512(values + i);
+            __m512i w = _mm512_loadu_si512(weights + i);
+            _mm512_storeu_si512(values + i, _mm512_add_epi16(v, w));
+        }
+        add_avx2(values + i, weights + i, size - i);
+    }
+
+    __attribute__((target("avx512f,avx512bw"))) void sub_avx512(int16_t *values, int16_t const *weights, int size)
+    {
+        int i = 0;
+        for (; i + 32 <= size; i += 32)
+        {
+            __m512i v = _mm512_loadu_si512(values + i);
+            __m512i w = _mm512_loadu_si512(weights + i);
+            _mm512_storeu_si512(values + i, _mm512_sub_epi16(v, w));
+        }
+        sub_avx2(values + i, weights + i, size - i);
+    }
+
+    __attribute__((target("avx512f,avx512bw"))) int32_t dot_avx512(uint8_t const *input, int8_t const *weights, int size)
+    {
+        __m512i ones = _mm512_set1_epi16(1);
+        __m512i sum = _mm512_setzero_si512();
+
+        int i = 0;
+        for (; i + 64 <= size; i += 64)
+        {
+            __m512i in = _mm512_loadu_si512(input + i);
+            __m512i w = _mm512_loadu_si512(weights + i);
+            __m512i pairs = _mm512_maddubs_epi16(in, w);
+            sum = _mm512_add_epi32(sum, _mm512_madd_epi16(pairs, ones));
+        }
+
+        // The last layers are only 32 wide, finish them with avx2
+        return _mm512_reduce_add_epi32(sum) + dot_avx2(input + i, weights + i, size - i);
+    }
+    __attribute__((target("avx512f,avx512bw"))) void affine_avx512(uint8_t const *input, int8_t const *weights, int32_t const *bias, int32_t *output, int inputs, int outputs)
+    {
+        // Narrow layers don't fill a register, avx2 does them just as well
+        if (inputs % 64)
+            return affine_avx2(input, weights, bias, output, inputs, outputs);
+
+        __m512i ones = _mm512_set1_epi16(1);
+        int o = 0;
+
+        for (; o + 4 <= outputs; o += 4)
+        {
+            int8_t const *row = weights + o * inputs;
+            __m512i sum[4] = {_mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512()};
+
+            for (int i = 0; i < inputs; i += 64)
+            {
+                __m512i in = _mm512_loadu_si512(input + i);
+                for (int r = 0; r < 4; r++)
+                {
+                    __m512i w = _mm512_loadu_si512(row + r * inputs + i);
+                    sum[r] = _mm512_add_epi32(sum[r], _mm512_madd_epi16(_mm512_maddubs_epi16(in, w), ones));
+                }
+            }
+
+            // Leaves each 128 bit lane holding the partial sums of
+            // the four rows, the lanes are then added through memory
+            __m512i low = _mm512_add_epi32(_mm512_unpacklo_epi32(sum[0], sum[1]), _mm512_unpackhi_epi32(sum[0], sum[1]));
+            __m512i high = _mm512_add_epi32(_mm512_unpacklo_epi32(sum[2], sum[3]), _mm512_unpackhi_epi32(sum[2], sum[3]));
+            __m512i rows = _mm512_add_epi32(_mm512_unpacklo_epi64(low, high), _mm512_unpackhi_epi64(low, high));
+
+            alignas(64) int32_t lanes[16];
+            _mm512_store_si512(lanes, rows);
+
+            for (int r = 0; r < 4; r++)
+                output[o + r] = bias[o + r] + lanes[r] + lanes[4 + r] + lanes[8 + r] + lanes[12 + r];
+        }
+
+        for (; o < outputs; o++)
+            output[o] = bias[o] + dot_avx512(input, weights + o * inputs, inputs);
+    }
+
+#endif
+
+    constexpr Kernels all_kernels[] = {
+        {add_scalar, sub_scalar, dot_scalar, affine_scalar, "scalar"},
+#ifdef SIMD_X86
+        {add_sse41, sub_sse41, dot_sse41, affine_sse41, "sse4.1"},
+        {add_avx2, sub_avx2, dot_avx2, affine_avx2, "avx2"},
+        {add_avx512, sub_avx512, dot_avx512, affine_avx512, "avx512"},
+#endif
+    };
+}
+
+namespace SIMD
+{
+    Level detect()
+    {
+#ifdef SIMD_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+            return Level::avx512;
+
+        if (__builtin_cpu_supports("avx2"))
+            return Level::avx2;
+
+        if (__builtin_cpu_supports("sse4.1"))
+            return Level::sse41;
+#endif
+        return Level::scalar;
+    }
+
+    Kernels const &get(Level level)
+    {
+        return all_kernels[to_int(level)];
+    }
+
+    Kernels const &kernels = get(detect());
+}
@@ -0,0 +1,62 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "misc.h"
+
+// Vectorised kernels for network inference. Every instruction set gets its
+// own version, compiled with a target attribute so that one binary runs
+// everywhere. The best version the cpu supports is picked once at startup
+namespace SIMD
+{
+    enum class Level : uint8_t
+    {
+        scalar,
+        sse41,
+        avx2,
+        avx512,
+        total
+    };
+
+    struct Kernels
+    {
+        // values[i] += weights[i]
+        void (*add)(int16_t *values, int16_t const *weights, int size);
+
+        // values[i] -= weights[i]
+        void (*sub)(int16_t *values, int16_t const *weights, int size);
+
+        // Sum of input[i] * weights[i]. Inputs have to be in [0, 127] so
+        // that pairs of products never saturate an int16
+        int32_t (*dot)(uint8_t const *input, int8_t const *weights, int size);
+
+        // output[o] = bias[o] + dot(input, weights[o]) for a whole layer with
+        // weights stored row by row, one call instead of one per output
+        void (*affine)(uint8_t const *input, int8_t const *weights, int32_t const *bias, int32_t *output, int inputs, int outputs);
+
+        char const *name;
+    };
+
+    // Best level supported by this cpu and the os
+    Level detect();
+
+    // Kernels of a given level, the level has to be supported
+    Kernels const &get(Level);
+
+    // Kernels of the detected level
+    extern Kernels const &kernels;
+}
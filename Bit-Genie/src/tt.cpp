@@ -17,33 +17,433 @@
 */
 #include "tt.h"
 #include "position.h"
+#include "search.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <thread>
+#include <vector>
 
-static inline int mb_to_b(int mb)
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Layout of a compressed entry
+    // bits  0-17 : lower 18 bits of the zobrist key
+    // bits 18-33 : move
+    // bits 34-49 : score
+    // bits 50-56 : depth
+    // bits 57-58 : flag
+    // bits 59-63 : generation
+    //
+    // A probe compares the key against all 8 entries of a bucket, so with 18
+    // bits about 1 in 32768 probes of a full table hits another position
+    constexpr int key_bits = 18;
+    constexpr uint32_t key_mask = (1u << key_bits) - 1;
+    constexpr int max_depth = 127;
+
+    inline uint64_t pack_entry(uint32_t key, TEntry const &entry, uint8_t generation)
+    {
+        return uint64_t(key)
+             | uint64_t(entry.move) << 18
+             | uint64_t(uint16_t(entry.score)) << 34
+             | uint64_t(std::min<int>(entry.depth, max_depth)) << 50
+             | uint64_t(entry.flag) << 57
+             | uint64_t(generation) << 59;
+    }
+
+    inline TEntry unpack_entry(uint64_t data)
+    {
+        TEntry entry;
+        entry.move = uint16_t(data >> 18);
+        entry.score = int16_t(uint16_t(data >> 34));
+        entry.depth = uint8_t((data >> 50) & max_depth);
+        entry.flag = TEFlag((data >> 57) & 3);
+        return entry;
+    }
+
+    inline int score_to_tt(int score, int ply)
+    {
+        return score >= MinMateScore ? score + ply : score <= -MinMateScore ? score - ply : score;
+    }
+
+    inline int score_from_tt(int score, int ply)
+    {
+        return score >= MinMateScore ? score - ply : score <= -MinMateScore ? score + ply : score;
+    }
+
+    // The bucket index comes from the high bits of the key, so the
+    // low bits are independent of it for any realistic table size
+    inline uint32_t entry_key(uint64_t data)
+    {
+        return uint32_t(data) & key_mask;
+    }
+
+    inline uint32_t verification_key(uint64_t hash)
+    {
+        return uint32_t(hash) & key_mask;
+    }
+
+    inline int entry_depth(uint64_t data)
+    {
+        return int(data >> 50) & max_depth;
+    }
+
+    inline TEFlag entry_flag(uint64_t data)
+    {
+        return TEFlag((data >> 57) & 3);
+    }
+
+    inline uint8_t entry_generation(uint64_t data)
+    {
+        return uint8_t(data >> 59);
+    }
+}
+
+namespace
 {
-    return mb * 1000000;
+    // Header at the start of a saved table. The buckets follow at the next
+    // page boundary so that the file can be mapped and searched in place
+    struct TFileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t bucket_size;
+        uint64_t zobrist;
+        uint64_t total_buckets;
+        uint8_t generation;
+    };
+
+    constexpr char file_magic[8] = "BGHASH";
+
+    // Bumped whenever the meaning of the stored data changes,
+    // 2: mate scores are stored relative to the node instead of the root
+    // 3: 18-bit keys, 7-bit depth and 5-bit generation
+    constexpr uint32_t file_version = 3;
+
+    constexpr uint64_t file_data_offset = 4096;
 }
 
+static inline uint64_t mb_to_b(int mb)
+{
+    return uint64_t(mb) * 1024 * 1024;
+}
+
+#if defined(__linux__)
+namespace
+{
+    constexpr uint64_t huge_page_size = 2 * 1024 * 1024;
+
+    uint64_t round_up(uint64_t bytes, uint64_t multiple)
+    {
+        return (bytes + multiple - 1) / multiple * multiple;
+    }
+
+    // The kernel only honours MADV_HUGEPAGE when THP is
+    // set to "always" or "madvise", not when it is "[never]"
+    bool transparent_pages_enabled()
+    {
+        std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+        std::string setting;
+        std::getline(file, setting);
+        return file && setting.find("[never]") == std::string::npos;
+    }
+
+    void *map_anonymous(uint64_t bytes, int flags)
+    {
+        void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+        return memory == MAP_FAILED ? nullptr : memory;
+    }
+}
+
+void TTable::allocate(uint64_t bytes)
+{
+    if (mode == PageMode::explicit_)
+    {
+        allocated = round_up(bytes, huge_page_size);
+        memory = map_anonymous(allocated, MAP_HUGETLB);
+
+        if (memory)
+        {
+            buckets = static_cast<TBucket *>(memory);
+            pages = "2048 KB pages (hugetlbfs)";
+            return;
+        }
+    }
+
+    // Over-allocate so that the table can start on a
+    // huge page boundary, otherwise THP can't back it
+    allocated = round_up(bytes, huge_page_size) + huge_page_size;
+    memory = map_anonymous(allocated, 0);
+
+    if (!memory)
+        throw std::bad_alloc();
+
+    auto aligned = round_up(reinterpret_cast<uintptr_t>(memory), huge_page_size);
+    buckets = reinterpret_cast<TBucket *>(aligned);
+
+    if (mode != PageMode::normal && transparent_pages_enabled() && !madvise(buckets, round_up(bytes, huge_page_size), MADV_HUGEPAGE))
+        pages = "2048 KB pages (transparent huge pages)";
+    else
+        pages = "4 KB pages";
+
+    if (mode == PageMode::explicit_)
+        pages += ", no hugetlbfs pages available";
+}
+
+void TTable::release()
+{
+    if (memory)
+        munmap(memory, allocated);
+    memory = nullptr;
+}
+#else
+void TTable::allocate(uint64_t bytes)
+{
+    allocated = bytes;
+    memory = ::operator new(bytes, std::align_val_t(alignof(TBucket)));
+    buckets = static_cast<TBucket *>(memory);
+    pages = "default pages";
+}
+
+void TTable::release()
+{
+    if (memory)
+        ::operator delete(memory, std::align_val_t(alignof(TBucket)));
+    memory = nullptr;
+}
+#endif
+
 TTable::TTable()
 {
     resize(32);
 }
 
-void TTable::resize(int mb)
+TTable::~TTable()
+{
+    release();
+}
+
+void TTable::resize(int mb, int threads)
 {
-    entries.resize(mb_to_b(mb) / sizeof(TEntry), TEntry());
+    release();
+
+    total_buckets = std::max<uint64_t>(1, mb_to_b(mb) / sizeof(TBucket));
+    allocate(total_buckets * sizeof(TBucket));
+    reset(threads);
 }
 
-void TTable::add(Position const &position, Move move, int score, uint8_t depth, TEFlag flag)
+void TTable::set_page_mode(PageMode new_mode, int threads)
 {
-    uint64_t hash = position.key.data();
-    uint64_t index = hash % entries.size();
+    mode = new_mode;
 
-    entries[index] = TEntry(hash, score, move, depth, flag);
+    release();
+    allocate(total_buckets * sizeof(TBucket));
+    reset(threads);
 }
 
-TEntry &TTable::retrieve(Position const &position)
+void TTable::reset(int threads)
 {
-    uint64_t hash = position.key.data();
-    uint64_t index = hash % entries.size();
-    return entries[index];
-}
\ No newline at end of file
+    threads = int(std::clamp<uint64_t>(threads, 1, total_buckets));
+
+    uint64_t slice = total_buckets / threads;
+    auto clear = [this](uint64_t begin, uint64_t end)
+    {
+        for (uint64_t i = begin; i < end; i++)
+        {
+            for (auto &entry : buckets[i].entries)
+                entry.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; i++)
+        workers.emplace_back(clear, slice * i, i == threads - 1 ? total_buckets : slice * (i + 1));
+
+    clear(0, slice);
+
+    for (auto &worker : workers)
+        worker.join();
+
+    generation = 0;
+}
+
+bool TTable::save(std::string const &path) const
+{
+    std::ofstream file(path, std::ios::binary);
+
+    TFileHeader header{};
+    std::memcpy(header.magic, file_magic, sizeof(file_magic));
+    header.version = file_version;
+    header.bucket_size = sizeof(TBucket);
+    header.zobrist = ZobristKey::signature();
+    header.total_buckets = total_buckets;
+    header.generation = generation;
+
+    std::vector<char> page(file_data_offset, 0);
+    std::memcpy(page.data(), &header, sizeof(header));
+
+    file.write(page.data(), page.size());
+    file.write(reinterpret_cast<char const *>(buckets), total_buckets * sizeof(TBucket));
+    return bool(file);
+}
+
+bool TTable::load(std::string const &path, std::string &error)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    uint64_t size = file.tellg();
+    TFileHeader header{};
+
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+    if (!file || std::memcmp(header.magic, file_magic, sizeof(file_magic)))
+        error = path + " is not a hash file";
+
+    else if (header.version != file_version || header.bucket_size != sizeof(TBucket))
+        error = path + " was saved by an incompatible version";
+
+    else if (header.zobrist != ZobristKey::signature())
+        error = path + " was saved with different zobrist keys";
+
+    else if (!header.total_buckets || size != file_data_offset + header.total_buckets * sizeof(TBucket))
+        error = path + " is truncated";
+
+    if (!error.empty())
+        return false;
+
+#if defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY);
+    void *mapping = fd == -1 ? MAP_FAILED : mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+    if (fd != -1)
+        close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        error = "cannot map " + path;
+        return false;
+    }
+
+    release();
+    memory = mapping;
+    allocated = size;
+    buckets = reinterpret_cast<TBucket *>(static_cast<char *>(mapping) + file_data_offset);
+    pages = "pages mapped from " + path;
+#else
+    release();
+    allocate(header.total_buckets * sizeof(TBucket));
+
+    file.seekg(file_data_offset);
+    file.read(reinterpret_cast<char *>(buckets), header.total_buckets * sizeof(TBucket));
+#endif
+
+    total_buckets = header.total_buckets;
+    generation = header.generation;
+    return true;
+}
+
+bool TTable::add(Position const &position, Move move, int score, uint8_t depth, TEFlag flag, int ply)
+{
+    return add(position.key.data(), move, score, depth, flag, ply);
+}
+
+bool TTable::add(uint64_t hash, Move move, int score, uint8_t depth, TEFlag flag, int ply)
+{
+    uint32_t key = verification_key(hash);
+    TBucket &bucket = buckets[index(hash)];
+
+    int replace = 0;
+    int lowest = std::numeric_limits<int>::max();
+
+    for (int i = 0; i < TBucket::size; i++)
+    {
+        uint64_t data = bucket.entries[i].load(std::memory_order_relaxed);
+
+        if (entry_key(data) == key || entry_flag(data) == TEFlag::none)
+        {
+            // Don't let a shallow search overwrite a deeper result
+            // for the same position from the current search
+            if (entry_key(data) == key
+             && entry_flag(data) != TEFlag::none
+             && flag != TEFlag::exact
+             && entry_generation(data) == generation
+             && depth + 3 < entry_depth(data))
+                return false;
+
+            replace = i;
+            break;
+        }
+
+        // Prefer replacing shallow entries and
+        // entries left behind by previous searches
+        int age = (generation - entry_generation(data)) & 31;
+        int value = entry_depth(data) - 8 * age;
+
+        if (value < lowest)
+        {
+            lowest = value;
+            replace = i;
+        }
+    }
+
+    uint64_t evicted = bucket.entries[replace].load(std::memory_order_relaxed);
+    bucket.entries[replace].store(pack_entry(key, TEntry(score_to_tt(score, ply), move, depth, flag), generation), std::memory_order_relaxed);
+
+    return entry_flag(evicted) != TEFlag::none && entry_key(evicted) != key;
+}
+
+int TTable::hashfull() const
+{
+    constexpr uint64_t sample = 1000 / TBucket::size;
+
+    int used = 0;
+    for (uint64_t i = 0; i < std::min(sample, total_buckets); i++)
+    {
+        for (auto const &entry : buckets[i].entries)
+        {
+            uint64_t data = entry.load(std::memory_order_relaxed);
+            used += entry_flag(data) != TEFlag::none && entry_generation(data) == generation;
+        }
+    }
+    return used * 1000 / int(std::min(sample, total_buckets) * TBucket::size);
+}
+
+bool TTable::retrieve(Position const &position, TEntry &entry, int ply) const
+{
+    return retrieve(position.key.data(), entry, ply);
+}
+
+bool TTable::retrieve(uint64_t hash, TEntry &entry, int ply) const
+{
+    uint32_t key = verification_key(hash);
+    TBucket const &bucket = buckets[index(hash)];
+
+    for (int i = 0; i < TBucket::size; i++)
+    {
+        // Read each entry exactly once, the bucket may
+        // be rewritten by another thread while we look at it
+        uint64_t data = bucket.entries[i].load(std::memory_order_relaxed);
+
+        if (entry_key(data) == key && entry_flag(data) != TEFlag::none)
+        {
+            entry = unpack_entry(data);
+            entry.score = score_from_tt(entry.score, ply);
+            return true;
+        }
+    }
+    return false;
+}
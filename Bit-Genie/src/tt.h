@@ -18,7 +18,13 @@
 #pragma once
 #include "misc.h"
 #include "move.h"
-#include <vector>
+#include <atomic>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <xmmintrin.h>
+#endif
 
 enum class TEFlag : uint8_t
 {
@@ -30,20 +36,44 @@ enum class TEFlag : uint8_t
 
 struct TEntry
 {
-    uint64_t hash = 0;
-    int32_t score = 0;
+    int16_t score = 0;
     uint16_t move = 0;
     uint8_t depth = 0;
     TEFlag flag = TEFlag::none;
 
     TEntry() = default;
 
-    TEntry(uint64_t h, int32_t s, Move m, uint8_t d, TEFlag fl)
-        : hash(h), score(s), move(move_without_score(m)), depth(d), flag(fl)
+    TEntry(int16_t s, Move m, uint8_t d, TEFlag fl)
+        : score(s), move(move_without_score(m)), depth(d), flag(fl)
     {
     }
 };
 
+// A cache line worth of entries. Every entry is compressed into a single
+// 64-bit word (key, move, score, depth, flag and generation). The words are
+// atomics read and written with relaxed ordering, so search threads share
+// the table without locks and can't tear an entry apart. On x86 these are
+// plain loads and stores
+struct alignas(64) TBucket
+{
+    static constexpr int size = 8;
+
+    std::atomic<uint64_t> entries[size];
+};
+
+// Saved tables are the raw bucket memory
+static_assert(std::atomic<uint64_t>::is_always_lock_free && sizeof(TBucket) == 64);
+
+// How the table memory is backed. Large tables thrash the TLB with
+// regular 4 KB pages, so by default we ask the kernel for transparent
+// huge pages and can optionally reserve explicit (hugetlbfs) pages
+enum class PageMode : uint8_t
+{
+    normal,
+    transparent,
+    explicit_
+};
+
 class TTable
 {
 public:
@@ -51,15 +81,81 @@ public:
 
     TTable(int mb) { resize(mb); }
 
-    void resize(int);
-    void add(Position const &, Move, int score, uint8_t depth, TEFlag);
-    void reset()
+    ~TTable();
+
+    TTable(TTable const &) = delete;
+    TTable &operator=(TTable const &) = delete;
+
+    // Resizing and clearing split the table into one contiguous slice per
+    // thread, so the pages get touched first by the threads that search
+    void resize(int mb, int threads = 1);
+    void set_page_mode(PageMode, int threads = 1);
+    void reset(int threads = 1);
+
+    // Returns true if the entry evicted a live entry of another position.
+    // Mate scores are passed in relative to the root and stored relative to
+    // the node at the given ply, so a transposition reached at another ply
+    // still gets the right mate distance back from retrieve()
+    bool add(Position const &, Move, int score, uint8_t depth, TEFlag, int ply);
+    bool add(uint64_t hash, Move, int score, uint8_t depth, TEFlag, int ply);
+
+    // Permill of the first 1000 entries that were written by the current search
+    int hashfull() const;
+
+    // Save the table to disk, or replace it with a previously saved one.
+    // Loading maps the file copy-on-write, the file itself is never modified
+    bool save(std::string const &path) const;
+    bool load(std::string const &path, std::string &error);
+
+    // Description of the pages that back the table, for an info string
+    std::string const &page_info() const
+    {
+        return pages;
+    }
+
+    // Age the table, entries from previous searches become
+    // the first candidates for replacement
+    void new_search()
     {
-        std::fill(entries.begin(), entries.end(), TEntry());
+        generation = (generation + 1) & 31;
     }
 
-    TEntry &retrieve(Position const &);
+    bool retrieve(Position const &, TEntry &, int ply) const;
+    bool retrieve(uint64_t hash, TEntry &, int ply) const;
+
+    // Start loading the bucket for the given key into the cache
+    // so a retrieve() shortly after doesn't stall on memory
+    void prefetch(uint64_t hash) const
+    {
+#if defined(_MSC_VER)
+        _mm_prefetch(reinterpret_cast<char const *>(&buckets[index(hash)]), _MM_HINT_T0);
+#else
+        __builtin_prefetch(&buckets[index(hash)]);
+#endif
+    }
 
 private:
-    std::vector<TEntry> entries;
-};
\ No newline at end of file
+    // Map the key onto [0, buckets) with a fixed-point multiply instead of a
+    // modulo. This works for any table size and uses the high bits of the key
+    uint64_t index(uint64_t hash) const
+    {
+#if defined(_MSC_VER)
+        return __umulh(hash, total_buckets);
+#else
+        return uint64_t((unsigned __int128)hash * total_buckets >> 64);
+#endif
+    }
+
+    void allocate(uint64_t bytes);
+    void release();
+
+    TBucket *buckets = nullptr;
+    uint64_t total_buckets = 0;
+
+    void *memory = nullptr;
+    uint64_t allocated = 0;
+    PageMode mode = PageMode::transparent;
+    std::string pages;
+
+    uint8_t generation = 0;
+};
@@ -0,0 +1,414 @@
+/*
+  Bit-Genie is an open-source, UCI-compliant chess engine written by
+  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie
+
+  Bit-Genie is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Bit-Genie is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "tuner.h"
+#include "eval.h"
+#include "evaltrace.h"
+#include "position.h"
+#include "stringparse.h"
+#include "stopwatch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int mg = 0;
+    constexpr int eg = 1;
+
+    using Parameters = std::vector<std::array<double, 2>>;
+
+    // Only the terms a position actually uses are kept,
+    // as the white minus black coefficient
+    struct TuneCoeff
+    {
+        uint16_t index;
+        int16_t coeff;
+    };
+
+    struct TuneEntry
+    {
+        uint32_t begin;
+        uint32_t end;
+        float result;
+        int16_t phase;
+        int16_t scale;
+    };
+
+    struct TuneData
+    {
+        std::vector<TuneEntry> entries;
+        std::vector<TuneCoeff> coeffs;
+    };
+
+    int mg_of(int score)
+    {
+        return (int16_t)((uint16_t)((unsigned)(score)));
+    }
+
+    int eg_of(int score)
+    {
+        return (int16_t)((uint16_t)((unsigned)(score + 0x8000) >> 16));
+    }
+
+    Parameters current_parameters()
+    {
+        Parameters params(Trace::total_terms);
+
+#define X(space, name)                                                   \
+    for (int i = 0; i < Trace::term_size(space::name); i++)             \
+    {                                                                    \
+        int score = Trace::term_values(space::name)[i];                  \
+        params[Trace::space##_##name + i] = {double(mg_of(score)), double(eg_of(score))}; \
+    }
+        EVAL_TERMS(X)
+#undef X
+        return params;
+    }
+
+    bool parse_result(std::string const &line, float &result)
+    {
+        if (line.find("1/2-1/2") != std::string::npos || line.find("[0.5]") != std::string::npos)
+            result = 0.5f;
+        else if (line.find("1-0") != std::string::npos || line.find("[1.0]") != std::string::npos)
+            result = 1.0f;
+        else if (line.find("0-1") != std::string::npos || line.find("[0.0]") != std::string::npos)
+            result = 0.0f;
+        else
+            return false;
+        return true;
+    }
+
+    bool load_entry(Position &position, TuneData &data, std::string const &line)
+    {
+        float result;
+        auto parts = split_string(line);
+
+        if (parts.size() < 4 || !parse_result(line, result))
+            return false;
+
+        if (!position.set_fen(parts[0] + " " + parts[1] + " " + parts[2] + " " + parts[3]))
+            return false;
+
+        EvalTrace trace;
+        trace_position(position, trace);
+
+        if (!trace.linear)
+            return false;
+
+        TuneEntry entry;
+        entry.begin = data.coeffs.size();
+        entry.result = result;
+        entry.phase = trace.phase;
+        entry.scale = trace.scale;
+
+        for (int i = 0; i < Trace::total_terms; i++)
+        {
+            int coeff = trace.coeffs[i][White] - trace.coeffs[i][Black];
+            if (coeff)
+                data.coeffs.push_back({uint16_t(i), int16_t(coeff)});
+        }
+
+        entry.end = data.coeffs.size();
+        data.entries.push_back(entry);
+        return true;
+    }
+
+    TuneData load_data(std::string const &path)
+    {
+        TuneData data;
+        std::ifstream file(path);
+        Position position;
+        int skipped = 0;
+
+        for (std::string line; std::getline(file, line);)
+        {
+            if (!load_entry(position, data, line))
+                skipped++;
+        }
+
+        std::cout << "loaded " << data.entries.size() << " positions, skipped " << skipped << std::endl;
+        return data;
+    }
+
+    double evaluate(TuneData const &data, TuneEntry const &entry, Parameters const &params)
+    {
+        double score[2] = {0, 0};
+
+        for (uint32_t i = entry.begin; i < entry.end; i++)
+        {
+            score[mg] += data.coeffs[i].coeff * params[data.coeffs[i].index][mg];
+            score[eg] += data.coeffs[i].coeff * params[data.coeffs[i].index][eg];
+        }
+
+        return (score[mg] * (256 - entry.phase) + score[eg] * entry.phase * entry.scale / 64.0) / 256.0;
+    }
+
+    double sigmoid(double K, double score)
+    {
+        return 1.0 / (1.0 + std::pow(10.0, -K * score / 400.0));
+    }
+
+    // Calls F(begin, end, thread) on equal slices of [0, count)
+    template <typename Callable>
+    void parallel_for(int threads, size_t count, Callable F)
+    {
+        std::vector<std::thread> workers;
+        size_t slice = (count + threads - 1) / threads;
+
+        for (int t = 0; t < threads; t++)
+        {
+            size_t begin = std::min(count, t * slice);
+            size_t end = std::min(count, begin + slice);
+            workers.emplace_back(F, begin, end, t);
+        }
+
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    double total_error(TuneData const &data, Parameters const &params, double K, int threads)
+    {
+        std::vector<double> errors(threads, 0.0);
+
+        parallel_for(threads, data.entries.size(), [&](size_t begin, size_t end, int t) {
+            for (size_t i = begin; i < end; i++)
+            {
+                TuneEntry const &entry = data.entries[i];
+                double error = entry.result - sigmoid(K, evaluate(data, entry, params));
+                errors[t] += error * error;
+            }
+        });
+
+        double total = 0;
+        for (double error : errors)
+            total += error;
+        return total / data.entries.size();
+    }
+
+    // The scaling constant that best maps the current scores to results
+    double find_k(TuneData const &data, Parameters const &params, int threads)
+    {
+        double low = 0.0, high = 5.0;
+
+        for (int i = 0; i < 40; i++)
+        {
+            double a = low + (high - low) / 3;
+            double b = high - (high - low) / 3;
+
+            if (total_error(data, params, a, threads) < total_error(data, params, b, threads))
+                high = b;
+            else
+                low = a;
+        }
+        return (low + high) / 2;
+    }
+
+    // Adds the gradient of the error over entries [begin, end) to gradient
+    void compute_gradient(TuneData const &data, std::vector<uint32_t> const &order, size_t begin, size_t end,
+                          Parameters const &params, double K, Parameters &gradient)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            TuneEntry const &entry = data.entries[order[i]];
+            double s = sigmoid(K, evaluate(data, entry, params));
+
+            // d(error)/d(score), constant factors are left to the learning rate
+            double delta = (s - entry.result) * s * (1 - s);
+            double mg_delta = delta * (256 - entry.phase) / 256.0;
+            double eg_delta = delta * entry.phase * entry.scale / (64.0 * 256.0);
+
+            for (uint32_t j = entry.begin; j < entry.end; j++)
+            {
+                gradient[data.coeffs[j].index][mg] += mg_delta * data.coeffs[j].coeff;
+                gradient[data.coeffs[j].index][eg] += eg_delta * data.coeffs[j].coeff;
+            }
+        }
+    }
+
+    void write_term(FILE *file, char const *name, int size, bool array, Parameters const &params, int index)
+    {
+        if (!array)
+        {
+            std::fprintf(file, "    constexpr int %s = S(%3d, %3d);\n", name,
+                         int(std::lround(params[index][mg])), int(std::lround(params[index][eg])));
+            return;
+        }
+
+        std::fprintf(file, "    constexpr int %s[%d]\n    {\n", name, size);
+        for (int i = 0; i < size; i++)
+        {
+            if (i % 8 == 0)
+                std::fprintf(file, "        ");
+
+            std::fprintf(file, "S(%3d, %3d), ", int(std::lround(params[index + i][mg])), int(std::lround(params[index + i][eg])));
+
+            if (i % 8 == 7 || i == size - 1)
+                std::fprintf(file, "\n");
+        }
+        std::fprintf(file, "    };\n");
+    }
+
+    void write_scores(std::string const &path, Parameters const &params)
+    {
+        FILE *file = std::fopen(path.c_str(), "w");
+        if (!file)
+        {
+            std::cout << "cannot write " << path << std::endl;
+            return;
+        }
+
+        std::fprintf(file, "%s",
+                     "\n"
+                     "/*\n"
+                     "  Bit-Genie is an open-source, UCI-compliant chess engine written by\n"
+                     "  Aryan Parekh - https://github.com/Aryan1508/Bit-Genie\n"
+                     "\n"
+                     "  Bit-Genie is free software: you can redistribute it and/or modify\n"
+                     "  it under the terms of the GNU General Public License as published by\n"
+                     "  the Free Software Foundation, either version 3 of the License, or\n"
+                     "  (at your option) any later version.\n"
+                     "\n"
+                     "  Bit-Genie is distributed in the hope that it will be useful,\n"
+                     "  but WITHOUT ANY WARRANTY; without even the implied warranty of\n"
+                     "  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the\n"
+                     "  GNU General Public License for more details.\n"
+                     "\n"
+                     "  You should have received a copy of the GNU General Public License\n"
+                     "  along with this program.  If not, see <http://www.gnu.org/licenses/>.\n"
+                     "*/\n"
+                     "#pragma once\n"
+                     "#include \"misc.h\"\n");
+
+        std::string space;
+
+        // King attack weights only pick the safety table entry, they aren't tuned
+        auto close_space = [&]() {
+            if (space == "KingEval")
+            {
+                std::fprintf(file, "\n    constexpr int attack_weight[%d]\n    {\n        ", Trace::term_size(KingEval::attack_weight));
+                for (int i = 0; i < Trace::term_size(KingEval::attack_weight); i++)
+                    std::fprintf(file, i ? ", %d" : "%d", KingEval::attack_weight[i]);
+                std::fprintf(file, "\n    };\n");
+            }
+            if (!space.empty())
+                std::fprintf(file, "}\n");
+        };
+
+#define X(nspace, name)                                                     \
+    if (space != #nspace)                                                   \
+    {                                                                       \
+        close_space();                                                      \
+        space = #nspace;                                                    \
+        std::fprintf(file, "\nnamespace %s\n{\n", #nspace);                 \
+    }                                                                       \
+    else                                                                    \
+        std::fprintf(file, "\n");                                           \
+    write_term(file, #name, Trace::term_size(nspace::name),                 \
+               std::is_array_v<decltype(nspace::name)>, params, Trace::nspace##_##name);
+        EVAL_TERMS(X)
+#undef X
+        close_space();
+
+        std::fclose(file);
+    }
+}
+
+void Tuner::run(Options const &options)
+{
+    StopWatch watch;
+    watch.go();
+
+    TuneData data = load_data(options.data);
+    if (data.entries.empty())
+        return;
+
+    int threads = std::max(1, options.threads);
+    size_t batch_size = std::min<size_t>(options.batch_size, data.entries.size());
+
+    Parameters params = current_parameters();
+    double K = find_k(data, params, threads);
+
+    std::cout << "K = " << K << ", initial error " << total_error(data, params, K, threads)
+              << " (" << watch.elapsed_time().count() << " ms)" << std::endl;
+
+    // Adam state
+    constexpr double beta1 = 0.9;
+    constexpr double beta2 = 0.999;
+    constexpr double epsilon = 1e-8;
+
+    Parameters momentum(Trace::total_terms), velocity(Trace::total_terms);
+    std::vector<Parameters> gradients(threads, Parameters(Trace::total_terms));
+    std::vector<uint32_t> order(data.entries.size());
+    std::mt19937 rng(0);
+    int step = 0;
+
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    for (int epoch = 1; epoch <= options.epochs; epoch++)
+    {
+        std::shuffle(order.begin(), order.end(), rng);
+
+        for (size_t batch = 0; batch + batch_size <= order.size(); batch += batch_size)
+        {
+            for (auto &gradient : gradients)
+                std::fill(gradient.begin(), gradient.end(), std::array<double, 2>{0, 0});
+
+            parallel_for(threads, batch_size, [&](size_t begin, size_t end, int t) {
+                compute_gradient(data, order, batch + begin, batch + end, params, K, gradients[t]);
+            });
+
+            step++;
+            double correction1 = 1 - std::pow(beta1, step);
+            double correction2 = 1 - std::pow(beta2, step);
+
+            for (int i = 0; i < Trace::total_terms; i++)
+            {
+                for (int phase : {mg, eg})
+                {
+                    double g = 0;
+                    for (auto const &gradient : gradients)
+                        g += gradient[i][phase];
+                    g /= batch_size;
+
+                    momentum[i][phase] = beta1 * momentum[i][phase] + (1 - beta1) * g;
+                    velocity[i][phase] = beta2 * velocity[i][phase] + (1 - beta2) * g * g;
+
+                    double m = momentum[i][phase] / correction1;
+                    double v = velocity[i][phase] / correction2;
+                    params[i][phase] -= options.learning_rate * m / (std::sqrt(v) + epsilon);
+                }
+            }
+        }
+
+        if (epoch % 10 == 0)
+        {
+            std::cout << "epoch " << epoch << " error " << total_error(data, params, K, threads)
+                      << " (" << watch.elapsed_time().count() << " ms)" << std::endl;
+            write_scores(options.output, params);
+        }
+    }
+
+    write_scores(options.output, params);
+    std::cout << "final error " << total_error(data, params, K, threads) << ", wrote " << options.output << std::endl;
+}
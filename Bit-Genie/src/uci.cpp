@@ -24,6 +24,8 @@
 #include "stringparse.h"
 #include "benchmark.h"
 #include "searchinit.h"
+#include "nnue.h"
+#include "tuner.h"
 
 const char *version = "5.4";
 
@@ -41,6 +43,11 @@ namespace
         printl("id author Aryan Parekh");
         printl("option name Hash type spin default 2 min 2 max 3000");
         printl("option name Clear Hash type button");
+        printl("option name Threads type spin default 1 min 1 max 256");
+        printl("option name HugePages type combo default Transparent var Off var Transparent var Explicit");
+        printl("option name HashStats type check default false");
+        printl("option name EvalFile type string default <empty>");
+        printl("option name LazyMargin type spin default 500 min 0 max 3000");
         printl("uciok");
     }
 
@@ -49,25 +56,110 @@ namespace
         printl("readyok");
     }
 
-    void uci_setoption(UciParser const &parser, TTable &tt)
+    void uci_stop(SearchInit &worker)
     {
-        auto [name, value] = parser.parse_setoption();
+        if (worker.is_searching())
+            worker.end();
+    }
+
+    void uci_evalfile(std::string const &path, Position &position, SearchInit &worker)
+    {
+        uci_stop(worker);
+
+        bool unload = path.empty() || path == "<empty>";
+        bool was_enabled = NNUE::enabled();
+
+        if (unload)
+            NNUE::unload();
+        else if (!NNUE::load(path))
+        {
+            printl("info string cannot load network from ", path);
+            return;
+        }
+
+        // Cached scores come from the previous evaluator, for
+        // the search threads and for this one (bench)
+        clear_eval_cache();
+        worker.clear_eval_caches();
+        position.accumulators.refresh(position);
+
+        if (!unload)
+            printl("info string network loaded from ", path);
+        else if (was_enabled)
+            printl("info string network unloaded");
+    }
+
+    void uci_setoption(UciParser const &parser, Position &position, TTable &tt, SearchInit &worker)
+    {
+        auto [name, raw_value] = parser.parse_setoption();
+        std::string value = raw_value;
+        tolower(value);
 
         if (name == "hash")
         {
             if (!string_is_number(value))
                 return;
-            tt.resize(std::stoi(value));
+            tt.resize(std::stoi(value), worker.thread_count());
+            printl("info string hash allocated with ", tt.page_info());
+        }
+
+        else if (name == "hugepages")
+        {
+            if (value == "off")
+                tt.set_page_mode(PageMode::normal, worker.thread_count());
+            else if (value == "transparent")
+                tt.set_page_mode(PageMode::transparent, worker.thread_count());
+            else if (value == "explicit")
+                tt.set_page_mode(PageMode::explicit_, worker.thread_count());
+            else
+                return;
+            printl("info string hash allocated with ", tt.page_info());
         }
 
         else if (name == "clear hash")
-            tt.reset();
+            tt.reset(worker.thread_count());
+
+        else if (name == "hashstats")
+            worker.set_hash_stats(value == "true");
+
+        else if (name == "threads")
+        {
+            if (!string_is_number(value))
+                return;
+            worker.set_threads(std::clamp(std::stoi(value), 1, 256));
+        }
+
+        else if (name == "lazymargin")
+        {
+            if (!string_is_number(value))
+                return;
+            set_lazy_margin(std::clamp(std::stoi(value), 0, 3000));
+        }
+
+        else if (name == "evalfile")
+            uci_evalfile(raw_value, position, worker);
     }
 
-    void uci_stop(SearchInit &worker)
+    void uci_savehash(UciParser const &parser, TTable &tt, SearchInit &worker)
     {
-        if (worker.is_searching())
-            worker.end();
+        uci_stop(worker);
+        std::string path = parser.parse_argument();
+
+        if (!tt.save(path))
+            printl("info string cannot write hash to ", path);
+        else
+            printl("info string hash saved to ", path);
+    }
+
+    void uci_loadhash(UciParser const &parser, TTable &tt, SearchInit &worker)
+    {
+        uci_stop(worker);
+        std::string error;
+
+        if (!tt.load(parser.parse_argument(), error))
+            printl("info string ", error);
+        else
+            printl("info string hash loaded with ", tt.page_info());
     }
 
     void uci_go(UciParser const &parser, Position &position, TTable &tt, SearchInit &worker)
@@ -75,6 +167,7 @@ namespace
         UciGo options = parser.parse_go(position.side);
 
         Search search;
+        search.hash_stats = worker.reports_hash_stats();
         search.limits.stopwatch.go();
         search.limits.max_depth = std::min(options.depth, 64);
         search.limits.stopped = false;
@@ -99,6 +192,7 @@ namespace
             search.limits.time_set = true;
         }
 
+        tt.new_search();
         worker.begin(search, position, tt);
     }
 
@@ -144,6 +238,24 @@ void uci_input_loop(int argc, char **argv)
         return;
     }
 
+    // tune <file> [epochs] [threads] [output]
+    if (argc > 2 && !strcmp(argv[1], "tune"))
+    {
+        Tuner::Options options;
+        options.data = argv[2];
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+        if (argc > 3 && string_is_number(argv[3]))
+            options.epochs = std::stoi(argv[3]);
+        if (argc > 4 && string_is_number(argv[4]))
+            options.threads = std::stoi(argv[4]);
+        if (argc > 5)
+            options.output = argv[5];
+
+        Tuner::run(options);
+        return;
+    }
+
     while (command.take_input())
     {
         if (command == UciCommands::quit)
@@ -165,7 +277,10 @@ void uci_input_loop(int argc, char **argv)
             printl(position);
 
         else if (command == UciCommands::perft)
-            BenchMark::perft(position, command.parse_perft());
+        {
+            uci_stop(worker);
+            BenchMark::perft(position, command.parse_perft(worker.thread_count()));
+        }
 
         else if (command == UciCommands::go)
             uci_go(command, position, table, worker);
@@ -174,12 +289,49 @@ void uci_input_loop(int argc, char **argv)
             uci_stop(worker);
 
         else if (command == UciCommands::setoption)
-            uci_setoption(command, table);
+            uci_setoption(command, position, table, worker);
+
+        else if (command == UciCommands::ucinewgame)
+        {
+            uci_stop(worker);
+            table.reset(worker.thread_count());
+        }
 
         else if (command == UciCommands::bench)
         {
-            table.reset();
+            table.reset(worker.thread_count());
             BenchMark::bench(position, table);
         }
+
+        else if (command == UciCommands::hashbench)
+            BenchMark::hash_probe(table);
+
+        // ttstress [threads]
+        else if (command == UciCommands::ttstress)
+        {
+            std::string threads = command.parse_argument();
+            BenchMark::tt_stress(string_is_number(threads) ? std::clamp(std::stoi(threads), 1, 256) : 4);
+        }
+
+        else if (command == UciCommands::matecheck)
+        {
+            uci_stop(worker);
+            BenchMark::mate_check();
+        }
+
+        else if (command == UciCommands::simdbench)
+            BenchMark::simd();
+
+        else if (command == UciCommands::attackbench)
+            BenchMark::attacks();
+
+        else if (command == UciCommands::savehash)
+            uci_savehash(command, table, worker);
+
+        else if (command == UciCommands::loadhash)
+            uci_loadhash(command, table, worker);
+
+        else if (command == UciCommands::eval)
+            print_eval_trace(position);
     }
 }
\ No newline at end of file
@@ -18,6 +18,7 @@
 #include "uciparse.h"
 #include "stringparse.h"
 #include "piece.h"
+#include <algorithm>
 #include <utility>
 
 bool UciParser::take_input()
@@ -27,17 +28,39 @@ bool UciParser::take_input()
     return bool(val);
 }
 
-int UciParser::parse_perft() const
+Perft::Options UciParser::parse_perft(int threads) const
 {
-    auto options = split_string(command);
+    Perft::Options options;
+    options.depth = 0;
+    options.threads = threads;
 
-    if (options.size() != 2)
-        return 0;
+    auto parts = split_string(command);
+
+    if (parts.size() < 2 || !string_is_number(parts[1]))
+        return options;
+
+    options.depth = std::stoi(parts[1]);
+
+    for (auto key = parts.begin() + 2; key < parts.end() - 1; key++)
+    {
+        std::string const &value = *(key + 1);
+
+        if (!string_is_number(value))
+            continue;
 
-    if (!string_is_number(options[1]))
-        return 0;
+        if (*key == "threads")
+            options.threads = std::clamp(std::stoi(value), 1, 256);
 
-    return std::stoi(options[1]);
+        else if (*key == "hash")
+            options.hash = std::clamp(std::stoi(value), 1, 65536);
+    }
+    return options;
+}
+
+std::string UciParser::parse_argument() const
+{
+    auto space = command.find(' ');
+    return space == std::string::npos ? "" : command.substr(space + 1);
 }
 
 bool UciParser::operator==(UciCommands type) const
@@ -71,9 +94,36 @@ bool UciParser::operator==(UciCommands type) const
     case UciCommands::setoption:
         return starts_with(command, "setoption");
 
+    case UciCommands::ucinewgame:
+        return command == "ucinewgame";
+
     case UciCommands::bench:
         return command == "bench";
 
+    case UciCommands::hashbench:
+        return command == "hashbench";
+
+    case UciCommands::ttstress:
+        return starts_with(command, "ttstress");
+
+    case UciCommands::matecheck:
+        return command == "matecheck";
+
+    case UciCommands::simdbench:
+        return command == "simdbench";
+
+    case UciCommands::attackbench:
+        return command == "attackbench";
+
+    case UciCommands::savehash:
+        return starts_with(command, "savehash");
+
+    case UciCommands::loadhash:
+        return starts_with(command, "loadhash");
+
+    case UciCommands::eval:
+        return command == "eval";
+
     default:
         return false;
         break;
@@ -184,8 +234,9 @@ UciParser::parse_setoption() const
 
         else if (token == "value")
         {
-            stream >> token;
-            value = std::move(tolower(token));
+            // Keep the rest of the line as it is, file
+            // paths may contain spaces and capitals
+            std::getline(stream >> std::ws, value);
             break;
         }
     }
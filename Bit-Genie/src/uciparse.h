@@ -19,6 +19,7 @@
 #include <sstream>
 #include <vector>
 #include "misc.h"
+#include "perft.h"
 
 enum class UciCommands
 {
@@ -29,11 +30,20 @@ enum class UciCommands
     go,
     stop,
     setoption,
+    ucinewgame,
 
     // *debugging/other purpose commands*
     print,
     perft,
-    bench
+    bench,
+    hashbench,
+    ttstress,
+    matecheck,
+    simdbench,
+    attackbench,
+    savehash,
+    loadhash,
+    eval
 };
 
 struct UciGo
@@ -59,7 +69,12 @@ public:
     std::pair<std::string, std::vector<std::string>>
     parse_position_command() const;
 
-    int parse_perft() const;
+    // perft <depth> [threads <n>] [hash <mb>], threads
+    // default to the value of the Threads option
+    Perft::Options parse_perft(int threads) const;
+
+    // Everything after the command name, i.e the file in "savehash <file>"
+    std::string parse_argument() const;
     UciGo parse_go(Color) const;
     std::pair<std::string, std::string>
     parse_setoption() const;
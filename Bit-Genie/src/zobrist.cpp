@@ -86,6 +86,28 @@ void ZobristKey::init()
     }
 }
 
+uint64_t ZobristKey::signature()
+{
+    uint64_t signature = color_key;
+    auto mix = [&](uint64_t key)
+    {
+        signature = ((signature << 7) | (signature >> 57)) ^ key;
+    };
+
+    for (auto key : enpassant_keys)
+        mix(key);
+
+    for (auto key : castle_keys)
+        mix(key);
+
+    for (auto &keys : piece_keys)
+    {
+        for (auto key : keys)
+            mix(key);
+    }
+    return signature;
+}
+
 void ZobristKey::hash_pieces(Position const &position)
 {
     for (Square sq = Square::A1; sq <= Square::H8; sq++)
@@ -122,6 +144,18 @@ void ZobristKey::generate(Position const &position)
     }
 }
 
+void ZobristKey::generate_pawns(Position const &position)
+{
+    reset();
+
+    uint64_t pawns = position.pieces.bitboards[Pawn];
+    while (pawns)
+    {
+        Square sq = pop_lsb(pawns);
+        hash_piece(sq, position.pieces.get_piece(sq));
+    }
+}
+
 std::ostream &operator<<(std::ostream &o, const ZobristKey key)
 {
     return o << std::hex << "0x" << key.hash << std::dec;
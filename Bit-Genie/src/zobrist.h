@@ -23,6 +23,7 @@ class ZobristKey
 public:
     ZobristKey();
     void generate(Position const &);
+    void generate_pawns(Position const &);
 
     void hash_side();
     void hash_ep(const Square);
@@ -34,6 +35,10 @@ public:
 
     static void init();
 
+    // Fingerprint of the random keys created by init(), used to
+    // check that saved hash entries were made with the same keys
+    static uint64_t signature();
+
     bool operator==(ZobristKey other) const
     {
         return hash == other.hash;